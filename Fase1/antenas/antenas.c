@@ -13,19 +13,18 @@
  #include <string.h>
  
  #include "antenas.h"
- 
- #define MAX_LINHAS 100
- #define MAX_COLUNAS 100
+ #include "../memoria/memoria.h"
  
  #pragma region carregarAntenasDeFicheiro
  /**
-  * @brief Lê um ficheiro linha a linha e insere antenas na lista ligada.
+  * @brief Lê um ficheiro carácter a carácter e insere antenas na lista ligada.
   * 
-  * Apenas são considerados como antenas os caracteres diferentes de '.' e '0'.
-  * As antenas são inseridas na lista com as coordenadas correspondentes.
+  * Apenas são consideradas antenas as letras. Não há limite para o número nem para o
+  * tamanho das linhas, e as coordenadas seguem as regras de obterDimensoesMapa
+  * (o '\r' das linhas terminadas em "\r\n" não conta como coluna).
   * 
   * @param ficheiro Nome do ficheiro de entrada.
-  * @return Ponteiro para a lista de antenas.
+  * @return Ponteiro para a lista de antenas, ou NULL se o ficheiro não abrir ou faltar memória.
   */
  Antena* carregarAntenasDeFicheiro(const char* ficheiro) {
      FILE* file = fopen(ficheiro, "r");
@@ -34,16 +33,25 @@
      }
  
      Antena* lista = NULL;
-     char linha[100];
-     int y = 0;
+     int c, x = 0, y = 0;
  
-     while (fgets(linha, sizeof(linha), file) && y < MAX_LINHAS) {
-         for (int x = 0; linha[x] != '\n' && linha[x] != '\0'; x++) {
-             if ((linha[x] >= 'A' && linha[x] <= 'Z') || (linha[x] >= 'a' && linha[x] <= 'z')) {
-                 lista = inserirAntena(lista, linha[x], x, y);
+     while ((c = fgetc(file)) != EOF) {
+         if (c == '\n') {
+             y++;
+             x = 0;
+             continue;
+         }
+         if (c == '\r') continue;
+         if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z')) {
+             Antena* nova = inserirAntena(lista, (char)c, x, y);
+             if (nova == lista) { // Sem memória: não é devolvida uma lista incompleta
+                 fclose(file);
+                 limparLista(lista);
+                 return NULL;
              }
+             lista = nova;
          }
-         y++;
+         x++;
      }
      fclose(file);
  
@@ -51,11 +59,55 @@
  }
  #pragma endregion
  
+ #pragma region obterDimensoesMapa
+ /**
+  * @brief Percorre o ficheiro carácter a carácter para obter as dimensões do mapa.
+  * 
+  * Uma última linha sem '\n' também é contabilizada.
+  * 
+  * @param ficheiro Nome do ficheiro de entrada.
+  * @param largura Ponteiro onde é guardada a largura do mapa.
+  * @param altura Ponteiro onde é guardada a altura do mapa.
+  * @return 1 se as dimensões foram obtidas, 0 caso contrário.
+  */
+ int obterDimensoesMapa(const char* ficheiro, int* largura, int* altura) {
+     if (!largura || !altura) return 0;
+
+     FILE* file = fopen(ficheiro, "r");
+     if (!file) {
+         return 0;
+     }
+ 
+     int c, coluna = 0;
+     *largura = 0;
+     *altura = 0;
+ 
+     while ((c = fgetc(file)) != EOF) {
+         if (c == '\n') {
+             if (coluna > *largura) *largura = coluna;
+             (*altura)++;
+             coluna = 0;
+         } else if (c != '\r') {
+             coluna++;
+         }
+     }
+     if (coluna > 0) { // Última linha sem '\n'
+         if (coluna > *largura) *largura = coluna;
+         (*altura)++;
+     }
+     fclose(file);
+ 
+     return 1;
+ }
+ #pragma endregion
+ 
  #pragma region inserirAntena
  /**
   * @brief Insere uma nova antena no início da lista ligada.
   * 
   * A nova antena será a nova cabeça da lista.
+  * Se não houver memória a lista é devolvida sem alterações e o motivo
+  * fica disponível em ultimoErroMemoria().
   * 
   * @param lista Cabeça da lista.
   * @param frequencia Carácter da antena.
@@ -64,7 +116,7 @@
   * @return Ponteiro para a nova cabeça da lista.
   */
  Antena* inserirAntena(Antena* lista, char frequencia, int x, int y) {
-     Antena* nova = (Antena*)malloc(sizeof(Antena));
+     Antena* nova = (Antena*)reservarMemoria(MEM_ANTENAS, sizeof(Antena));
      if (nova == NULL) {
          return lista;
      }
@@ -99,7 +151,7 @@
                  lista = atual->prox;
              }
  
-             free(atual);
+             libertarMemoria(MEM_ANTENAS, atual, sizeof(Antena));
              return lista; // Retorna a nova cabeça da lista
          }
          anterior = atual;
@@ -121,7 +173,7 @@
      while (lista != NULL) {
          aux = lista;
          lista = lista->prox;
-         free(aux);
+         libertarMemoria(MEM_ANTENAS, aux, sizeof(Antena));
      }
  }
  #pragma endregion
@@ -148,4 +200,176 @@
  
      printf("+------------------+\n");
  }
- #pragma endregion
\ No newline at end of file
+ #pragma endregion
+ 
+ #pragma region armazemAdicionar
+ /**
+  * @brief Acrescenta uma antena ao fim do armazém, crescendo o vetor quando necessário.
+  * 
+  * A primeira antena com coordenadas negativas ou acima de COORD_COMPACTA_MAX faz com que
+  * todos os registos sejam copiados para a variante larga.
+  * 
+  * @param arm Armazém de antenas.
+  * @param frequencia Carácter da antena.
+  * @param x Coordenada X.
+  * @param y Coordenada Y.
+  * @param indice Ponteiro onde é guardado o índice da nova antena (pode ser NULL).
+  * @return 1 em caso de sucesso, 0 caso contrário.
+  */
+ int armazemAdicionar(ArmazemAntenas* arm, char frequencia, int x, int y, uint32_t* indice) {
+     if (!arm || frequencia == 0 || arm->total == UINT32_MAX) return 0;
+ 
+     int cabe = x >= 0 && x <= COORD_COMPACTA_MAX && y >= 0 && y <= COORD_COMPACTA_MAX;
+     if (!arm->largas && !cabe) {
+         // Conversão para a variante larga
+         uint32_t cap = arm->capacidade ? arm->capacidade : 1;
+         AntenaLarga* largas = (AntenaLarga*)reservarMemoria(MEM_ANTENAS, (size_t)cap * sizeof(AntenaLarga));
+         if (largas == NULL) return 0;
+         for (uint32_t i = 0; i < arm->total; i++) {
+             largas[i].x = armazemX(arm, i);
+             largas[i].y = armazemY(arm, i);
+             largas[i].frequencia = armazemFrequencia(arm, i);
+         }
+         libertarMemoria(MEM_ANTENAS, arm->compactas, (size_t)arm->capacidade * sizeof(AntenaCompacta));
+         arm->compactas = NULL;
+         arm->largas = largas;
+         arm->capacidade = cap;
+     }
+ 
+     if (arm->total == arm->capacidade) {
+         uint32_t novaCap = arm->capacidade ? arm->capacidade * 2 : 16;
+         if (novaCap < arm->capacidade) novaCap = UINT32_MAX;
+         if (arm->largas) {
+             AntenaLarga* novo = (AntenaLarga*)redimensionarMemoria(MEM_ANTENAS, arm->largas,
+                 (size_t)arm->capacidade * sizeof(AntenaLarga), (size_t)novaCap * sizeof(AntenaLarga));
+             if (novo == NULL) return 0;
+             arm->largas = novo;
+         } else {
+             AntenaCompacta* novo = (AntenaCompacta*)redimensionarMemoria(MEM_ANTENAS, arm->compactas,
+                 (size_t)arm->capacidade * sizeof(AntenaCompacta), (size_t)novaCap * sizeof(AntenaCompacta));
+             if (novo == NULL) return 0;
+             arm->compactas = novo;
+         }
+         arm->capacidade = novaCap;
+     }
+ 
+     uint32_t i = arm->total++;
+     if (arm->largas) {
+         arm->largas[i].x = x;
+         arm->largas[i].y = y;
+         arm->largas[i].frequencia = frequencia;
+     } else {
+         arm->compactas[i].bits = (uint64_t)x
+                                | ((uint64_t)y << 24)
+                                | ((uint64_t)(unsigned char)frequencia << 48);
+     }
+     if (indice) *indice = i;
+ 
+     return 1;
+ }
+ #pragma endregion
+ 
+ #pragma region armazemDefinirFrequencia
+ /**
+  * @brief Substitui a frequência de um registo do armazém, mantendo as coordenadas.
+  * 
+  * @param arm Armazém de antenas.
+  * @param indice Índice da antena.
+  * @param frequencia Nova frequência (0 marca a posição como livre).
+  * @return 1 em caso de sucesso, 0 se o índice for inválido.
+  */
+ int armazemDefinirFrequencia(ArmazemAntenas* arm, uint32_t indice, char frequencia) {
+     if (!arm || indice >= arm->total) return 0;
+ 
+     if (arm->largas) {
+         arm->largas[indice].frequencia = frequencia;
+     } else {
+         arm->compactas[indice].bits = (arm->compactas[indice].bits & ~((uint64_t)0xFF << 48))
+                                     | ((uint64_t)(unsigned char)frequencia << 48);
+     }
+     return 1;
+ }
+ #pragma endregion
+ 
+ #pragma region armazemAgruparPorFrequencia
+ /**
+  * @brief Agrupa os índices do armazém por frequência (contagem seguida de soma prefixa).
+  * 
+  * @param arm Armazém de antenas.
+  * @param inicio Vetor com 257 posições preenchido com o início de cada grupo.
+  * @return Vetor de índices agrupados, ou NULL em caso de erro.
+  */
+ uint32_t* armazemAgruparPorFrequencia(const ArmazemAntenas* arm, uint32_t inicio[257]) {
+     for (int f = 0; f <= 256; f++) inicio[f] = 0;
+     if (!arm) return NULL;
+ 
+     for (uint32_t i = 0; i < arm->total; i++) {
+         unsigned char f = (unsigned char)armazemFrequencia(arm, i);
+         if (f != 0) inicio[f + 1]++;
+     }
+     for (int f = 0; f < 256; f++) inicio[f + 1] += inicio[f];
+ 
+     uint32_t* grupos = (uint32_t*)reservarMemoria(MEM_ANTENAS, (inicio[256] ? inicio[256] : 1) * sizeof(uint32_t));
+     if (grupos == NULL) return NULL;
+ 
+     uint32_t pos[256];
+     for (int f = 0; f < 256; f++) pos[f] = inicio[f];
+     for (uint32_t i = 0; i < arm->total; i++) {
+         unsigned char f = (unsigned char)armazemFrequencia(arm, i);
+         if (f != 0) grupos[pos[f]++] = i;
+     }
+     return grupos;
+ }
+ 
+ /**
+  * @brief Liberta o vetor devolvido por armazemAgruparPorFrequencia.
+  * 
+  * @param grupos Vetor de índices agrupados (ou NULL).
+  * @param inicio Início de cada grupo, preenchido na mesma chamada.
+  */
+ void libertarGruposFrequencia(uint32_t* grupos, const uint32_t inicio[257]) {
+     if (grupos == NULL) return;
+     libertarMemoria(MEM_ANTENAS, grupos, (inicio[256] ? inicio[256] : 1) * sizeof(uint32_t));
+ }
+ #pragma endregion
+ 
+ #pragma region criarArmazem
+ /**
+  * @brief Copia as antenas da lista ligada para um armazém contíguo.
+  * 
+  * A antena na posição i da lista fica com o índice i no armazém.
+  * 
+  * @param lista Cabeça da lista.
+  * @return Ponteiro para o armazém, ou NULL em caso de erro.
+  */
+ ArmazemAntenas* criarArmazem(Antena* lista) {
+     ArmazemAntenas* arm = (ArmazemAntenas*)reservarMemoriaZeros(MEM_ANTENAS, 1, sizeof(ArmazemAntenas));
+     if (arm == NULL) {
+         return NULL;
+     }
+ 
+     for (Antena* a = lista; a != NULL; a = a->prox) {
+         if (!armazemAdicionar(arm, a->frequencia, a->x, a->y, NULL)) {
+             libertarArmazem(arm);
+             return NULL;
+         }
+     }
+ 
+     return arm;
+ }
+ #pragma endregion
+ 
+ #pragma region libertarArmazem
+ /**
+  * @brief Liberta os vetores de registos e o próprio armazém.
+  * 
+  * @param arm Armazém de antenas.
+  */
+ void libertarArmazem(ArmazemAntenas* arm) {
+     if (!arm) return;
+     size_t tamanho = arm->largas ? sizeof(AntenaLarga) : sizeof(AntenaCompacta);
+     libertarMemoria(MEM_ANTENAS, arm->compactas ? (void*)arm->compactas : (void*)arm->largas,
+                     (size_t)arm->capacidade * tamanho);
+     libertarMemoria(MEM_ANTENAS, arm, sizeof(ArmazemAntenas));
+ }
+ #pragma endregion
@@ -11,6 +11,9 @@
  
  #include <stdio.h>
  #include <stdlib.h>
+ #include <stdint.h>
+
+ #include "../memoria/memoria.h"
 
  /**
   * @struct Antena
@@ -25,20 +28,91 @@
      int y;            /**< Coordenada Y da antena */
      //Aresta* adj; /**< Ponteiro para a lista de arestas (antenas adjacentes) */
      struct Antena* prox; /**< Ponteiro para a próxima antena na lista ligada */
-     int visitado;   // usado no DFS/BFS
  } Antena;
+
+ /** @brief Maior coordenada representável numa AntenaCompacta (24 bits). */
+ #define COORD_COMPACTA_MAX 0xFFFFFF
+
+ /**
+  * @struct AntenaCompacta
+  * @brief Registo de antena empacotado em 8 bytes.
+  *
+  * Bits 0-23: coordenada X; bits 24-47: coordenada Y; bits 48-55: frequência.
+  * Uma frequência 0 indica uma posição livre no armazém.
+  */
+ typedef struct AntenaCompacta {
+     uint64_t bits;  /**< Campos empacotados */
+ } AntenaCompacta;
+
+ /**
+  * @struct AntenaLarga
+  * @brief Variante do registo de antena para mapas com coordenadas acima de 24 bits.
+  */
+ typedef struct AntenaLarga {
+     int32_t x;        /**< Coordenada X da antena */
+     int32_t y;        /**< Coordenada Y da antena */
+     char frequencia;  /**< Frequência da antena (0 se a posição estiver livre) */
+ } AntenaLarga;
+
+ /**
+  * @struct ArmazemAntenas
+  * @brief Vetor contíguo de antenas acedidas por índice de 32 bits.
+  *
+  * Enquanto todas as coordenadas couberem em 24 bits são usados registos compactos;
+  * caso contrário o armazém passa a usar a variante larga. Só um dos vetores é usado.
+  */
+ typedef struct ArmazemAntenas {
+     AntenaCompacta* compactas;  /**< Registos compactos (ou NULL) */
+     AntenaLarga* largas;        /**< Registos largos (ou NULL) */
+     uint32_t total;             /**< Número de registos usados */
+     uint32_t capacidade;        /**< Capacidade do vetor em uso */
+ } ArmazemAntenas;
+
+ /**
+  * @brief Frequência da antena com o índice dado.
+  */
+ static inline char armazemFrequencia(const ArmazemAntenas* arm, uint32_t i) {
+     return arm->largas ? arm->largas[i].frequencia : (char)((arm->compactas[i].bits >> 48) & 0xFF);
+ }
+
+ /**
+  * @brief Coordenada X da antena com o índice dado.
+  */
+ static inline int armazemX(const ArmazemAntenas* arm, uint32_t i) {
+     return arm->largas ? arm->largas[i].x : (int)(arm->compactas[i].bits & COORD_COMPACTA_MAX);
+ }
+
+ /**
+  * @brief Coordenada Y da antena com o índice dado.
+  */
+ static inline int armazemY(const ArmazemAntenas* arm, uint32_t i) {
+     return arm->largas ? arm->largas[i].y : (int)((arm->compactas[i].bits >> 24) & COORD_COMPACTA_MAX);
+ }
  
  /**
   * @brief Lê um ficheiro e armazena as antenas na lista ligada.
   * 
   * Esta função abre um ficheiro de texto que representa um mapa da cidade
-  * e insere todas as antenas encontradas numa lista ligada.
-  * São ignorados os caracteres '.' e '0'.
+  * e insere todas as antenas (letras) encontradas numa lista ligada.
+  * As linhas podem ter qualquer tamanho e o mapa qualquer número de linhas.
   * 
   * @param filename Nome do ficheiro de entrada.
-  * @return Ponteiro para a cabeça da lista de antenas.
+  * @return Ponteiro para a cabeça da lista de antenas, ou NULL se o ficheiro não abrir ou faltar memória.
   */
  Antena* carregarAntenasDeFicheiro(const char* ficheiro);
+
+ /**
+  * @brief Obtém as dimensões do mapa guardado num ficheiro.
+  * 
+  * A largura corresponde à linha mais comprida (sem o '\n') e a altura
+  * ao número de linhas do ficheiro.
+  * 
+  * @param ficheiro Nome do ficheiro de entrada.
+  * @param largura Ponteiro onde é guardada a largura do mapa.
+  * @param altura Ponteiro onde é guardada a altura do mapa.
+  * @return 1 se as dimensões foram obtidas, 0 caso contrário.
+  */
+ int obterDimensoesMapa(const char* ficheiro, int* largura, int* altura);
  
  /**
   * @brief Cria um novo nó de antena.
@@ -92,5 +166,68 @@
   * @param lista Cabeça da lista ligada.
   */
  void listarAntenas(Antena* lista);
+
+ /**
+  * @brief Cria um armazém com as antenas da lista ligada, pela mesma ordem.
+  * 
+  * @param lista Cabeça da lista ligada.
+  * @return Ponteiro para o armazém, ou NULL em caso de erro.
+  */
+ ArmazemAntenas* criarArmazem(Antena* lista);
+
+ /**
+  * @brief Acrescenta uma antena ao fim do armazém.
+  * 
+  * Se as coordenadas não couberem num registo compacto, o armazém é convertido
+  * para a variante larga (os índices existentes mantêm-se).
+  * 
+  * @param arm Armazém de antenas.
+  * @param frequencia Caracter representando a frequência da antena (diferente de 0).
+  * @param x Coordenada X da antena.
+  * @param y Coordenada Y da antena.
+  * @param indice Ponteiro onde é guardado o índice da nova antena.
+  * @return 1 se a antena foi acrescentada, 0 caso contrário.
+  */
+ int armazemAdicionar(ArmazemAntenas* arm, char frequencia, int x, int y, uint32_t* indice);
+
+ /**
+  * @brief Altera a frequência de uma antena do armazém.
+  * 
+  * Uma frequência 0 marca a posição como livre (antena removida); o índice
+  * não é reutilizado, pelo que os índices das restantes antenas se mantêm.
+  * 
+  * @param arm Armazém de antenas.
+  * @param indice Índice da antena.
+  * @param frequencia Nova frequência (0 para remover).
+  * @return 1 se a frequência foi alterada, 0 caso contrário.
+  */
+ int armazemDefinirFrequencia(ArmazemAntenas* arm, uint32_t indice, char frequencia);
+
+ /**
+  * @brief Agrupa os índices das antenas do armazém por frequência.
+  * 
+  * Os índices da frequência f ocupam as posições [inicio[f], inicio[f + 1]) do vetor
+  * devolvido, por ordem crescente. As posições livres (frequência 0) são ignoradas.
+  * 
+  * @param arm Armazém de antenas.
+  * @param inicio Vetor com 257 posições preenchido com o início de cada grupo.
+  * @return Vetor de índices agrupados (a libertar com libertarGruposFrequencia), ou NULL em caso de erro.
+  */
+ uint32_t* armazemAgruparPorFrequencia(const ArmazemAntenas* arm, uint32_t inicio[257]);
+
+ /**
+  * @brief Liberta o vetor devolvido por armazemAgruparPorFrequencia.
+  * 
+  * @param grupos Vetor de índices agrupados (ou NULL).
+  * @param inicio Início de cada grupo, preenchido na mesma chamada.
+  */
+ void libertarGruposFrequencia(uint32_t* grupos, const uint32_t inicio[257]);
+
+ /**
+  * @brief Liberta toda a memória de um armazém de antenas.
+  * 
+  * @param arm Armazém de antenas.
+  */
+ void libertarArmazem(ArmazemAntenas* arm);
  
  #endif 
\ No newline at end of file
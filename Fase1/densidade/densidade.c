@@ -0,0 +1,511 @@
+/**
+ * @author Tomás Cerqueira Gomes (a31501@alunos.ipca.pt)
+ * @date 2025-05-18
+ *
+ * @file densidade.c
+ * @brief Implementação do índice de somas prefixas 2D (summed-area tables) de efeitos e antenas.
+*/
+
+#include <string.h>
+
+#include "densidade.h"
+#include "../memoria/memoria.h"
+
+#define LADO_LADRILHO 16  /**< Lado de cada ladrilho (as somas locais cabem num byte: 15 x 15 <= 255) */
+
+#pragma region tamanhosTabelas
+/**
+ * @brief Calcula o tamanho em bytes de cada tabela do índice.
+ *
+ * @param indice Índice com as dimensões, as opções e o número de camadas definidos.
+ * @param tamanhos Vetor onde são guardados os tamanhos de somas, locais, cantos, faixasH e faixasV.
+ */
+static void tamanhosTabelas(const IndiceDensidade* indice, size_t tamanhos[5]) {
+    size_t camadas = (size_t)indice->numCamadas;
+    size_t largura = (size_t)indice->largura;
+    size_t altura = (size_t)indice->altura;
+    size_t lx = (size_t)indice->ladrilhosX;
+    size_t ly = (size_t)indice->ladrilhosY;
+
+    memset(tamanhos, 0, 5 * sizeof(size_t));
+    if (indice->opcoes & DENSIDADE_LADRILHOS) {
+        tamanhos[1] = camadas * lx * ly * LADO_LADRILHO * LADO_LADRILHO * sizeof(uint8_t);
+        tamanhos[2] = camadas * lx * ly * sizeof(uint32_t);
+        tamanhos[3] = camadas * (altura + 1) * lx * sizeof(uint32_t);
+        tamanhos[4] = camadas * (largura + 1) * ly * sizeof(uint32_t);
+    } else {
+        tamanhos[0] = camadas * (largura + 1) * (altura + 1) * sizeof(uint32_t);
+    }
+}
+#pragma endregion
+
+#pragma region libertarTabelas
+/**
+ * @brief Liberta as tabelas do índice (o próprio índice continua reservado).
+ *
+ * @param indice Índice de densidade.
+ */
+static void libertarTabelas(IndiceDensidade* indice) {
+    size_t tamanhos[5];
+    tamanhosTabelas(indice, tamanhos);
+    libertarMemoria(MEM_OUTROS, indice->somas, tamanhos[0]);
+    libertarMemoria(MEM_OUTROS, indice->locais, tamanhos[1]);
+    libertarMemoria(MEM_OUTROS, indice->cantos, tamanhos[2]);
+    libertarMemoria(MEM_OUTROS, indice->faixasH, tamanhos[3]);
+    libertarMemoria(MEM_OUTROS, indice->faixasV, tamanhos[4]);
+    indice->somas = NULL;
+    indice->locais = NULL;
+    indice->cantos = NULL;
+    indice->faixasH = NULL;
+    indice->faixasV = NULL;
+    indice->numCamadas = 0;
+    indice->bytes = 0;
+}
+#pragma endregion
+
+#pragma region prepararCamadas
+/**
+ * @brief Atribui as camadas às frequências presentes e reserva as tabelas.
+ *
+ * @param indice Índice de densidade (sem tabelas).
+ * @param inicio Início de cada grupo de frequência no armazém (NULL se não houver armazém).
+ * @return 1 em caso de sucesso, 0 se faltar memória.
+ */
+static int prepararCamadas(IndiceDensidade* indice, const uint32_t inicio[257]) {
+    indice->numCamadas = 2;
+    for (int f = 0; f < 256; f++) indice->camadaFrequencia[f] = -1;
+    if ((indice->opcoes & DENSIDADE_POR_FREQUENCIA) && inicio) {
+        for (int f = 1; f < 256; f++) {
+            if (inicio[f + 1] > inicio[f]) indice->camadaFrequencia[f] = (int16_t)indice->numCamadas++;
+        }
+    }
+
+    size_t tamanhos[5];
+    tamanhosTabelas(indice, tamanhos);
+    if (indice->opcoes & DENSIDADE_LADRILHOS) {
+        indice->locais = (uint8_t*)reservarMemoria(MEM_OUTROS, tamanhos[1]);
+        indice->cantos = (uint32_t*)reservarMemoria(MEM_OUTROS, tamanhos[2]);
+        indice->faixasH = (uint32_t*)reservarMemoria(MEM_OUTROS, tamanhos[3]);
+        indice->faixasV = (uint32_t*)reservarMemoria(MEM_OUTROS, tamanhos[4]);
+        if (!indice->locais || !indice->cantos || !indice->faixasH || !indice->faixasV) {
+            libertarTabelas(indice);
+            return 0;
+        }
+    } else {
+        indice->somas = (uint32_t*)reservarMemoria(MEM_OUTROS, tamanhos[0]);
+        if (!indice->somas) {
+            libertarTabelas(indice);
+            return 0;
+        }
+    }
+    indice->bytes = tamanhos[0] + tamanhos[1] + tamanhos[2] + tamanhos[3] + tamanhos[4];
+    return 1;
+}
+#pragma endregion
+
+#pragma region construirSimples
+/**
+ * @brief Calcula as somas prefixas de uma camada na forma simples, a partir de uma linha.
+ *
+ * Cada linha é a linha anterior mais a soma acumulada das marcas da própria linha.
+ *
+ * @param indice Índice de densidade.
+ * @param camada Camada a calcular.
+ * @param marcas Grelha de bits das posições marcadas (a partir da linha inicial).
+ * @param palavras Palavras de 64 bits por linha de marcas.
+ * @param linhaInicial Primeira linha a recalcular.
+ */
+static void construirSimples(IndiceDensidade* indice, int camada, const uint64_t* marcas, size_t palavras,
+                             int linhaInicial) {
+    int largura = indice->largura;
+    uint32_t* somas = indice->somas + (size_t)camada * (largura + 1) * (indice->altura + 1);
+
+    if (linhaInicial == 0) memset(somas, 0, (largura + 1) * sizeof(uint32_t));
+    for (int y = linhaInicial; y < indice->altura; y++) {
+        const uint32_t* anterior = somas + (size_t)y * (largura + 1);
+        uint32_t* linha = somas + (size_t)(y + 1) * (largura + 1);
+        const uint64_t* m = marcas + (size_t)(y - linhaInicial) * palavras;
+        uint32_t acumulado = 0;
+        linha[0] = 0;
+        for (int x = 0; x < largura; x++) {
+            acumulado += (uint32_t)(m[x >> 6] >> (x & 63)) & 1;
+            linha[x + 1] = anterior[x + 1] + acumulado;
+        }
+    }
+}
+#pragma endregion
+
+#pragma region construirLadrilhos
+/**
+ * @brief Calcula as tabelas de uma camada na forma em ladrilhos, a partir de uma linha de ladrilhos.
+ *
+ * Percorre as linhas do mapa uma vez, mantendo a soma prefixa até ao topo do ladrilho atual
+ * (para os cantos e as faixas verticais), a soma à esquerda de cada ladrilho desde o seu topo
+ * (faixas horizontais) e a soma local de cada ladrilho.
+ *
+ * @param indice Índice de densidade.
+ * @param camada Camada a calcular.
+ * @param marcas Grelha de bits das posições marcadas (a partir da linha inicial).
+ * @param palavras Palavras de 64 bits por linha de marcas.
+ * @param linhaInicial Primeira linha a recalcular (múltiplo de LADO_LADRILHO).
+ * @param prefixo Vetor temporário com largura + 1 posições.
+ * @param faixa Vetor temporário com ladrilhosX posições.
+ */
+static void construirLadrilhos(IndiceDensidade* indice, int camada, const uint64_t* marcas, size_t palavras,
+                               int linhaInicial, uint32_t* prefixo, uint32_t* faixa) {
+    int largura = indice->largura;
+    int altura = indice->altura;
+    int lx = indice->ladrilhosX;
+    int ly = indice->ladrilhosY;
+    uint8_t* locais = indice->locais + (size_t)camada * lx * ly * LADO_LADRILHO * LADO_LADRILHO;
+    uint32_t* cantos = indice->cantos + (size_t)camada * lx * ly;
+    uint32_t* faixasH = indice->faixasH + (size_t)camada * (altura + 1) * lx;
+    uint32_t* faixasV = indice->faixasV + (size_t)camada * (largura + 1) * ly;
+    int ty0 = linhaInicial / LADO_LADRILHO;
+
+    // Soma de [0, x) x [0, linhaInicial): vem das tabelas das linhas que não mudam
+    for (int x = 0; x <= largura; x++) {
+        prefixo[x] = ty0 == 0 ? 0 : cantos[ty0 * lx + x / LADO_LADRILHO] + faixasV[(size_t)x * ly + ty0];
+    }
+
+    for (int ty = ty0; ty < ly; ty++) {
+        int topo = ty * LADO_LADRILHO;
+        for (int tx = 0; tx < lx; tx++) {
+            cantos[ty * lx + tx] = prefixo[tx * LADO_LADRILHO];
+            faixa[tx] = 0;
+        }
+        for (int x = 0; x <= largura; x++) {
+            faixasV[(size_t)x * ly + ty] = prefixo[x] - cantos[ty * lx + x / LADO_LADRILHO];
+        }
+
+        for (int dy = 0; dy < LADO_LADRILHO; dy++) {
+            int y = topo + dy;
+            const uint64_t* m = y < altura ? marcas + (size_t)(y - linhaInicial) * palavras : NULL;
+            if (y <= altura) {
+                for (int tx = 0; tx < lx; tx++) faixasH[(size_t)y * lx + tx] = faixa[tx];
+            }
+
+            uint32_t antes = 0;       // Marcas da linha y nas colunas [0, x)
+            uint32_t antesLadrilho = 0; // Marcas da linha y nas colunas [0, início do ladrilho)
+            for (int x = 0; x < lx * LADO_LADRILHO; x++) {
+                int tx = x / LADO_LADRILHO;
+                int dx = x % LADO_LADRILHO;
+                if (dx == 0) {
+                    antesLadrilho = antes;
+                    faixa[tx] += antes;
+                }
+                uint8_t* local = locais + ((size_t)ty * lx + tx) * LADO_LADRILHO * LADO_LADRILHO;
+                if (dy == 0) local[dx] = 0;
+                if (dy + 1 < LADO_LADRILHO) {
+                    local[(dy + 1) * LADO_LADRILHO + dx] = (uint8_t)(local[dy * LADO_LADRILHO + dx] + (antes - antesLadrilho));
+                }
+                if (x <= largura) prefixo[x] += antes;
+                if (m && x < largura) antes += (uint32_t)(m[x >> 6] >> (x & 63)) & 1;
+            }
+        }
+    }
+}
+#pragma endregion
+
+#pragma region marcarPosicao
+/**
+ * @brief Marca uma posição na grelha de bits, se estiver dentro da zona a recalcular.
+ */
+static void marcarPosicao(const IndiceDensidade* indice, uint64_t* marcas, size_t palavras,
+                          int linhaInicial, int x, int y) {
+    if (x < 0 || x >= indice->largura || y < linhaInicial || y >= indice->altura) return;
+    marcas[(size_t)(y - linhaInicial) * palavras + (x >> 6)] |= (uint64_t)1 << (x & 63);
+}
+#pragma endregion
+
+#pragma region calcularCamadas
+/**
+ * @brief Recalcula todas as camadas a partir de uma linha.
+ *
+ * As marcas de cada camada são colocadas numa grelha de bits temporária (só com as linhas
+ * a recalcular) e convertidas em somas. As antenas são agrupadas por frequência uma vez,
+ * pelo que o custo não depende do número de frequências.
+ *
+ * @param indice Índice com as tabelas reservadas.
+ * @param efeitos Lista de efeitos.
+ * @param antenas Armazém de antenas.
+ * @param grupos Índices das antenas agrupados por frequência (NULL se não houver armazém).
+ * @param inicio Início de cada grupo.
+ * @param linhaInicial Primeira linha a recalcular.
+ * @return 1 em caso de sucesso, 0 se faltar memória.
+ */
+static int calcularCamadas(IndiceDensidade* indice, const Efeito* efeitos, const ArmazemAntenas* antenas,
+                           const uint32_t* grupos, const uint32_t inicio[257], int linhaInicial) {
+    int ladrilhos = (indice->opcoes & DENSIDADE_LADRILHOS) != 0;
+    if (ladrilhos) linhaInicial -= linhaInicial % LADO_LADRILHO;
+
+    size_t palavras = ((size_t)indice->largura + 63) / 64;
+    size_t linhas = (size_t)(indice->altura - linhaInicial);
+    size_t numMarcas = palavras * linhas;
+    if (numMarcas == 0) numMarcas = 1;
+    size_t tamPrefixo = ((size_t)indice->largura + 1) * sizeof(uint32_t);
+    size_t tamFaixa = (indice->ladrilhosX ? (size_t)indice->ladrilhosX : 1) * sizeof(uint32_t);
+    uint64_t* marcas = (uint64_t*)reservarMemoria(MEM_OUTROS, numMarcas * sizeof(uint64_t));
+    uint32_t* prefixo = ladrilhos ? (uint32_t*)reservarMemoria(MEM_OUTROS, tamPrefixo) : NULL;
+    uint32_t* faixa = ladrilhos ? (uint32_t*)reservarMemoria(MEM_OUTROS, tamFaixa) : NULL;
+    int ok = marcas != NULL && (!ladrilhos || (prefixo != NULL && faixa != NULL));
+
+    for (int camada = 0; ok && camada < indice->numCamadas; camada++) {
+        memset(marcas, 0, numMarcas * sizeof(uint64_t));
+        if (camada == 0) {
+            for (const Efeito* e = efeitos; e != NULL; e = e->prox) {
+                marcarPosicao(indice, marcas, palavras, linhaInicial, e->x, e->y);
+            }
+        } else if (grupos) {
+            // Camada 1: todas as frequências; restantes: só a frequência da camada
+            for (int f = 1; f < 256; f++) {
+                if (camada != 1 && indice->camadaFrequencia[f] != camada) continue;
+                for (uint32_t i = inicio[f]; i < inicio[f + 1]; i++) {
+                    marcarPosicao(indice, marcas, palavras, linhaInicial,
+                                  armazemX(antenas, grupos[i]), armazemY(antenas, grupos[i]));
+                }
+            }
+        }
+
+        if (ladrilhos) {
+            construirLadrilhos(indice, camada, marcas, palavras, linhaInicial, prefixo, faixa);
+        } else {
+            construirSimples(indice, camada, marcas, palavras, linhaInicial);
+        }
+    }
+
+    libertarMemoria(MEM_OUTROS, marcas, numMarcas * sizeof(uint64_t));
+    libertarMemoria(MEM_OUTROS, prefixo, tamPrefixo);
+    libertarMemoria(MEM_OUTROS, faixa, tamFaixa);
+    return ok;
+}
+#pragma endregion
+
+#pragma region criarIndiceDensidade
+/**
+ * @brief Constrói o índice de densidade a partir dos efeitos e do armazém de antenas.
+ *
+ * @param efeitos Lista de efeitos (pode ser NULL).
+ * @param antenas Armazém de antenas (pode ser NULL).
+ * @param largura Largura do mapa.
+ * @param altura Altura do mapa.
+ * @param opcoes Combinação de OpcoesDensidade.
+ * @return Índice construído, ou NULL em caso de erro.
+ */
+IndiceDensidade* criarIndiceDensidade(const Efeito* efeitos, const ArmazemAntenas* antenas,
+                                      int largura, int altura, int opcoes) {
+    if (largura < 0 || altura < 0) return NULL;
+
+    IndiceDensidade* indice = (IndiceDensidade*)reservarMemoriaZeros(MEM_OUTROS, 1, sizeof(IndiceDensidade));
+    if (indice == NULL) return NULL;
+    indice->largura = largura;
+    indice->altura = altura;
+    indice->opcoes = opcoes;
+    indice->ladrilhosX = largura / LADO_LADRILHO + 1;
+    indice->ladrilhosY = altura / LADO_LADRILHO + 1;
+
+    if (!reconstruirIndiceDensidade(indice, efeitos, antenas, 0)) {
+        libertarIndiceDensidade(indice);
+        return NULL;
+    }
+    return indice;
+}
+#pragma endregion
+
+#pragma region reconstruirIndiceDensidade
+/**
+ * @brief Reconstrói o índice depois de o mapa mudar, reaproveitando as tabelas.
+ *
+ * @param indice Índice a reconstruir.
+ * @param efeitos Lista de efeitos atual (pode ser NULL).
+ * @param antenas Armazém de antenas atual (pode ser NULL).
+ * @param linhaInicial Primeira linha alterada.
+ * @return 1 em caso de sucesso, 0 em caso de erro (o índice deixa de ser válido).
+ */
+int reconstruirIndiceDensidade(IndiceDensidade* indice, const Efeito* efeitos,
+                               const ArmazemAntenas* antenas, int linhaInicial) {
+    if (!indice) return 0;
+
+    uint32_t inicio[257];
+    uint32_t* grupos = NULL;
+    if (antenas && antenas->total > 0) {
+        grupos = armazemAgruparPorFrequencia(antenas, inicio);
+        if (grupos == NULL) {
+            libertarTabelas(indice);
+            return 0;
+        }
+    }
+
+    // Tabelas novas se ainda não existirem ou se surgir uma frequência sem camada
+    int novas = indice->numCamadas == 0;
+    if (!novas && grupos && (indice->opcoes & DENSIDADE_POR_FREQUENCIA)) {
+        for (int f = 1; f < 256 && !novas; f++) {
+            novas = inicio[f + 1] > inicio[f] && indice->camadaFrequencia[f] < 0;
+        }
+    }
+    if (novas) {
+        libertarTabelas(indice);
+        if (!prepararCamadas(indice, grupos ? inicio : NULL)) {
+            libertarGruposFrequencia(grupos, inicio);
+            return 0;
+        }
+        linhaInicial = 0;
+    }
+
+    if (linhaInicial < 0) linhaInicial = 0;
+    if (linhaInicial > indice->altura) linhaInicial = indice->altura;
+    int ok = calcularCamadas(indice, efeitos, antenas, grupos, inicio, linhaInicial);
+    libertarGruposFrequencia(grupos, inicio);
+    if (!ok) libertarTabelas(indice);
+    return ok;
+}
+#pragma endregion
+
+#pragma region somaPrefixa
+/**
+ * @brief Soma de uma camada em [0, x) x [0, y).
+ *
+ * @param indice Índice de densidade.
+ * @param camada Camada (já validada).
+ * @param x Coluna limite (0 a largura).
+ * @param y Linha limite (0 a altura).
+ * @return Número de posições marcadas.
+ */
+static uint32_t somaPrefixa(const IndiceDensidade* indice, int camada, int x, int y) {
+    if (!(indice->opcoes & DENSIDADE_LADRILHOS)) {
+        size_t linha = (size_t)indice->largura + 1;
+        return indice->somas[(size_t)camada * linha * (indice->altura + 1) + (size_t)y * linha + x];
+    }
+
+    int lx = indice->ladrilhosX;
+    int ly = indice->ladrilhosY;
+    int tx = x / LADO_LADRILHO;
+    int ty = y / LADO_LADRILHO;
+    size_t ladrilho = (size_t)camada * lx * ly + (size_t)ty * lx + tx;
+    return indice->cantos[ladrilho]
+         + indice->faixasH[(size_t)camada * (indice->altura + 1) * lx + (size_t)y * lx + tx]
+         + indice->faixasV[(size_t)camada * (indice->largura + 1) * ly + (size_t)x * ly + ty]
+         + indice->locais[ladrilho * LADO_LADRILHO * LADO_LADRILHO
+                          + (y % LADO_LADRILHO) * LADO_LADRILHO + x % LADO_LADRILHO];
+}
+#pragma endregion
+
+#pragma region contarRetangulo
+/**
+ * @brief Limita um retângulo (com cantos em qualquer ordem) ao mapa.
+ *
+ * @return Área da parte dentro do mapa (0 se estiver fora).
+ */
+static long long limitarRetangulo(const IndiceDensidade* indice, int* x0, int* y0, int* x1, int* y1) {
+    if (*x0 > *x1) { int t = *x0; *x0 = *x1; *x1 = t; }
+    if (*y0 > *y1) { int t = *y0; *y0 = *y1; *y1 = t; }
+    if (*x0 < 0) *x0 = 0;
+    if (*y0 < 0) *y0 = 0;
+    if (*x1 >= indice->largura) *x1 = indice->largura - 1;
+    if (*y1 >= indice->altura) *y1 = indice->altura - 1;
+    if (*x0 > *x1 || *y0 > *y1) return 0;
+    return (long long)(*x1 - *x0 + 1) * (*y1 - *y0 + 1);
+}
+
+/**
+ * @brief Conta as posições marcadas de uma camada num retângulo (inclusive).
+ */
+static uint32_t contarRetangulo(const IndiceDensidade* indice, int camada, int x0, int y0, int x1, int y1) {
+    if (!indice || camada < 0 || camada >= indice->numCamadas) return 0;
+    if (limitarRetangulo(indice, &x0, &y0, &x1, &y1) == 0) return 0;
+    return somaPrefixa(indice, camada, x1 + 1, y1 + 1) - somaPrefixa(indice, camada, x0, y1 + 1)
+         - somaPrefixa(indice, camada, x1 + 1, y0) + somaPrefixa(indice, camada, x0, y0);
+}
+
+/**
+ * @brief Camada das antenas de uma frequência (0 para todas).
+ */
+static int camadaAntenas(const IndiceDensidade* indice, char frequencia) {
+    return frequencia == 0 ? 1 : indice->camadaFrequencia[(unsigned char)frequencia];
+}
+#pragma endregion
+
+#pragma region contarEfeitosRetangulo
+/**
+ * @brief Conta as posições com efeito num retângulo, em O(1).
+ *
+ * @param indice Índice de densidade.
+ * @param x0 Coordenada X do primeiro canto (inclusive).
+ * @param y0 Coordenada Y do primeiro canto (inclusive).
+ * @param x1 Coordenada X do canto oposto (inclusive).
+ * @param y1 Coordenada Y do canto oposto (inclusive).
+ * @return Número de posições com efeito na parte do retângulo dentro do mapa.
+ */
+uint32_t contarEfeitosRetangulo(const IndiceDensidade* indice, int x0, int y0, int x1, int y1) {
+    return contarRetangulo(indice, 0, x0, y0, x1, y1);
+}
+#pragma endregion
+
+#pragma region contarAntenasRetangulo
+/**
+ * @brief Conta as antenas num retângulo, em O(1).
+ *
+ * @param indice Índice de densidade.
+ * @param frequencia Frequência a contar, ou 0 para todas.
+ * @param x0 Coordenada X do primeiro canto (inclusive).
+ * @param y0 Coordenada Y do primeiro canto (inclusive).
+ * @param x1 Coordenada X do canto oposto (inclusive).
+ * @param y1 Coordenada Y do canto oposto (inclusive).
+ * @return Número de antenas na parte do retângulo dentro do mapa (0 se a frequência não tiver camada).
+ */
+uint32_t contarAntenasRetangulo(const IndiceDensidade* indice, char frequencia, int x0, int y0, int x1, int y1) {
+    if (!indice) return 0;
+    return contarRetangulo(indice, camadaAntenas(indice, frequencia), x0, y0, x1, y1);
+}
+#pragma endregion
+
+#pragma region densidadeEfeitosRetangulo
+/**
+ * @brief Fração das posições de um retângulo com efeito.
+ *
+ * @param indice Índice de densidade.
+ * @param x0 Coordenada X do primeiro canto (inclusive).
+ * @param y0 Coordenada Y do primeiro canto (inclusive).
+ * @param x1 Coordenada X do canto oposto (inclusive).
+ * @param y1 Coordenada Y do canto oposto (inclusive).
+ * @return Densidade entre 0 e 1 (0 se o retângulo não tiver posições dentro do mapa).
+ */
+double densidadeEfeitosRetangulo(const IndiceDensidade* indice, int x0, int y0, int x1, int y1) {
+    if (!indice) return 0.0;
+    long long area = limitarRetangulo(indice, &x0, &y0, &x1, &y1);
+    return area ? (double)contarRetangulo(indice, 0, x0, y0, x1, y1) / (double)area : 0.0;
+}
+#pragma endregion
+
+#pragma region densidadeAntenasRetangulo
+/**
+ * @brief Fração das posições de um retângulo com antena da frequência indicada (0 para todas).
+ *
+ * @param indice Índice de densidade.
+ * @param frequencia Frequência a contar, ou 0 para todas.
+ * @param x0 Coordenada X do primeiro canto (inclusive).
+ * @param y0 Coordenada Y do primeiro canto (inclusive).
+ * @param x1 Coordenada X do canto oposto (inclusive).
+ * @param y1 Coordenada Y do canto oposto (inclusive).
+ * @return Densidade entre 0 e 1 (0 se o retângulo não tiver posições dentro do mapa).
+ */
+double densidadeAntenasRetangulo(const IndiceDensidade* indice, char frequencia, int x0, int y0, int x1, int y1) {
+    if (!indice) return 0.0;
+    long long area = limitarRetangulo(indice, &x0, &y0, &x1, &y1);
+    return area ? (double)contarRetangulo(indice, camadaAntenas(indice, frequencia), x0, y0, x1, y1) / (double)area
+                : 0.0;
+}
+#pragma endregion
+
+#pragma region libertarIndiceDensidade
+/**
+ * @brief Liberta a memória do índice.
+ *
+ * @param indice Índice de densidade.
+ */
+void libertarIndiceDensidade(IndiceDensidade* indice) {
+    if (!indice) return;
+    libertarTabelas(indice);
+    libertarMemoria(MEM_OUTROS, indice, sizeof(IndiceDensidade));
+}
+#pragma endregion
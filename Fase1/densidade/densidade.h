@@ -0,0 +1,128 @@
+/**
+ * @author Tomás Cerqueira Gomes (a31501@alunos.ipca.pt)
+ * @date 2025-05-18
+ *
+ * @file densidade.h
+ * @brief Índice de somas prefixas 2D para contar efeitos e antenas em retângulos.
+*/
+
+#ifndef DENSIDADE_H
+#define DENSIDADE_H
+
+#include <stdint.h>
+#include "../efeitos/efeitos.h"
+
+/**
+ * @enum OpcoesDensidade
+ * @brief Opções de construção do índice (podem ser combinadas com |).
+ */
+typedef enum OpcoesDensidade {
+    DENSIDADE_SIMPLES = 0,         /**< Camadas de efeitos e de todas as antenas, tabela completa */
+    DENSIDADE_POR_FREQUENCIA = 1,  /**< Acrescenta uma camada por frequência presente */
+    DENSIDADE_LADRILHOS = 2        /**< Forma compacta em ladrilhos (cerca de 1,5 bytes por posição) */
+} OpcoesDensidade;
+
+/**
+ * @struct IndiceDensidade
+ * @brief Tabelas de somas prefixas (summed-area tables) de cada camada do mapa.
+ *
+ * A camada 0 contém os efeitos, a camada 1 todas as antenas e as seguintes uma frequência cada.
+ * Cada posição conta no máximo uma vez por camada. Na forma simples, a soma de [0, X) x [0, Y)
+ * está em somas[(Y * (largura + 1)) + X]. Na forma em ladrilhos de 16 x 16, a mesma soma é
+ * a soma de quatro parcelas: o canto do ladrilho, a faixa horizontal à esquerda do ladrilho,
+ * a faixa vertical acima do ladrilho e a soma local dentro do ladrilho (1 byte).
+ */
+typedef struct IndiceDensidade {
+    int largura;                  /**< Largura do mapa */
+    int altura;                   /**< Altura do mapa */
+    int opcoes;                   /**< Opções de construção (OpcoesDensidade) */
+    int numCamadas;               /**< Número de camadas */
+    int16_t camadaFrequencia[256];/**< Camada de cada frequência, ou -1 */
+    uint32_t* somas;              /**< Forma simples: (largura + 1) x (altura + 1) por camada */
+    int ladrilhosX;               /**< Forma em ladrilhos: ladrilhos por linha */
+    int ladrilhosY;               /**< Forma em ladrilhos: linhas de ladrilhos */
+    uint8_t* locais;              /**< Somas locais (16 x 16 por ladrilho) */
+    uint32_t* cantos;             /**< Soma acima e à esquerda de cada ladrilho */
+    uint32_t* faixasH;            /**< Soma à esquerda do ladrilho, da linha do topo até y (por linha) */
+    uint32_t* faixasV;            /**< Soma acima do ladrilho, da coluna inicial até x (por coluna) */
+    size_t bytes;                 /**< Memória ocupada pelas tabelas */
+} IndiceDensidade;
+
+/**
+ * @brief Constrói o índice de densidade a partir dos efeitos e do armazém de antenas.
+ *
+ * Custo O(largura x altura x camadas + efeitos + antenas). Posições fora do mapa são ignoradas.
+ *
+ * @param efeitos Lista de efeitos (pode ser NULL).
+ * @param antenas Armazém de antenas (pode ser NULL).
+ * @param largura Largura do mapa.
+ * @param altura Altura do mapa.
+ * @param opcoes Combinação de OpcoesDensidade.
+ * @return Índice construído, ou NULL em caso de erro.
+ */
+IndiceDensidade* criarIndiceDensidade(const Efeito* efeitos, const ArmazemAntenas* antenas,
+                                      int largura, int altura, int opcoes);
+
+/**
+ * @brief Reconstrói o índice depois de o mapa mudar, reaproveitando as tabelas.
+ *
+ * Só são recalculadas as linhas a partir de linhaInicial (as somas das linhas anteriores
+ * não dependem das posições abaixo). Passe 0 se não souber onde estão as alterações.
+ * Se aparecer uma frequência sem camada, o índice é reconstruído por inteiro.
+ *
+ * @param indice Índice a reconstruir.
+ * @param efeitos Lista de efeitos atual (pode ser NULL).
+ * @param antenas Armazém de antenas atual (pode ser NULL).
+ * @param linhaInicial Primeira linha alterada.
+ * @return 1 em caso de sucesso, 0 em caso de erro (o índice deixa de ser válido).
+ */
+int reconstruirIndiceDensidade(IndiceDensidade* indice, const Efeito* efeitos,
+                               const ArmazemAntenas* antenas, int linhaInicial);
+
+/**
+ * @brief Conta as posições com efeito num retângulo, em O(1).
+ *
+ * @param indice Índice de densidade.
+ * @param x0 Coordenada X do primeiro canto (inclusive).
+ * @param y0 Coordenada Y do primeiro canto (inclusive).
+ * @param x1 Coordenada X do canto oposto (inclusive).
+ * @param y1 Coordenada Y do canto oposto (inclusive).
+ * @return Número de posições com efeito na parte do retângulo dentro do mapa.
+ */
+uint32_t contarEfeitosRetangulo(const IndiceDensidade* indice, int x0, int y0, int x1, int y1);
+
+/**
+ * @brief Conta as antenas num retângulo, em O(1).
+ *
+ * @param indice Índice de densidade.
+ * @param frequencia Frequência a contar, ou 0 para todas.
+ * @param x0 Coordenada X do primeiro canto (inclusive).
+ * @param y0 Coordenada Y do primeiro canto (inclusive).
+ * @param x1 Coordenada X do canto oposto (inclusive).
+ * @param y1 Coordenada Y do canto oposto (inclusive).
+ * @return Número de antenas na parte do retângulo dentro do mapa (0 se a frequência não tiver camada).
+ */
+uint32_t contarAntenasRetangulo(const IndiceDensidade* indice, char frequencia, int x0, int y0, int x1, int y1);
+
+/**
+ * @brief Fração das posições de um retângulo com efeito.
+ *
+ * @return Densidade entre 0 e 1 (0 se o retângulo não tiver posições dentro do mapa).
+ */
+double densidadeEfeitosRetangulo(const IndiceDensidade* indice, int x0, int y0, int x1, int y1);
+
+/**
+ * @brief Fração das posições de um retângulo com antena da frequência indicada (0 para todas).
+ *
+ * @return Densidade entre 0 e 1 (0 se o retângulo não tiver posições dentro do mapa).
+ */
+double densidadeAntenasRetangulo(const IndiceDensidade* indice, char frequencia, int x0, int y0, int x1, int y1);
+
+/**
+ * @brief Liberta a memória do índice.
+ *
+ * @param indice Índice de densidade.
+ */
+void libertarIndiceDensidade(IndiceDensidade* indice);
+
+#endif
@@ -8,6 +8,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 
 #include "efeitos.h"
 
@@ -66,24 +67,21 @@ int efeitoExiste(Efeito* lista, int x, int y) {
 }
 #pragma endregion
 
-#pragma region adicionarEfeito
+#pragma region novoEfeito
 /**
- * @brief Adiciona um novo efeito à lista de efeitos.
+ * @brief Insere um efeito no início da lista sem verificar se já existe.
  * 
- * Esta função adiciona um novo efeito com as coordenadas fornecidas à lista ligada de efeitos nefastos.
- * Antes de adicionar, a função verifica se o efeito já existe na lista para evitar duplicação de efeitos.
- * A inserção do novo efeito é feita no início da lista.
+ * Usada diretamente quando a verificação de duplicados já foi feita de outra forma
+ * (por exemplo, com uma grelha de bits).
  * 
  * @param lista Ponteiro para a cabeça da lista de efeitos.
  * @param x Coordenada X do novo efeito.
  * @param y Coordenada Y do novo efeito.
  * @return Nova cabeça da lista de efeitos.
  */
-Efeito* adicionarEfeito(Efeito* lista, int x, int y) {
-    if (efeitoExiste(lista, x, y)) return lista;  // Se o efeito já existir na lista, não faz nada
-
+static Efeito* novoEfeito(Efeito* lista, int x, int y) {
     // Cria um novo nó para o efeito
-    Efeito* novo = (Efeito*)malloc(sizeof(Efeito));
+    Efeito* novo = (Efeito*)reservarMemoria(MEM_EFEITOS, sizeof(Efeito));
     if (novo == NULL) {
         return lista;
     }
@@ -95,6 +93,26 @@ Efeito* adicionarEfeito(Efeito* lista, int x, int y) {
 }
 #pragma endregion
 
+#pragma region adicionarEfeito
+/**
+ * @brief Adiciona um novo efeito à lista de efeitos.
+ * 
+ * Esta função adiciona um novo efeito com as coordenadas fornecidas à lista ligada de efeitos nefastos.
+ * Antes de adicionar, a função verifica se o efeito já existe na lista para evitar duplicação de efeitos.
+ * A inserção do novo efeito é feita no início da lista.
+ * 
+ * @param lista Ponteiro para a cabeça da lista de efeitos.
+ * @param x Coordenada X do novo efeito.
+ * @param y Coordenada Y do novo efeito.
+ * @return Nova cabeça da lista de efeitos.
+ */
+Efeito* adicionarEfeito(Efeito* lista, int x, int y) {
+    if (efeitoExiste(lista, x, y)) return lista;  // Se o efeito já existir na lista, não faz nada
+
+    return novoEfeito(lista, x, y);
+}
+#pragma endregion
+
 #pragma region deduzirEfeitosNefastos
 /**
  * @brief Gera uma lista de localizações com efeito nefasto a partir das antenas.
@@ -125,6 +143,643 @@ Efeito* deduzirEfeitosNefastos(Antena* lista) {
 }
 #pragma endregion
 
+#pragma region passoReta
+/**
+ * @brief Calcula o máximo divisor comum de dois inteiros não negativos.
+ * 
+ * @param a Primeiro valor.
+ * @param b Segundo valor.
+ * @return Máximo divisor comum de a e b.
+ */
+static int mdc(int a, int b) {
+    while (b != 0) {
+        int resto = a % b;
+        a = b;
+        b = resto;
+    }
+    return a;
+}
+
+/**
+ * @brief Calcula o menor passo inteiro sobre a reta que vai de (ax, ay) a (bx, by).
+ * 
+ * @param ax Coordenada X da primeira antena.
+ * @param ay Coordenada Y da primeira antena.
+ * @param bx Coordenada X da segunda antena.
+ * @param by Coordenada Y da segunda antena.
+ * @param passoX Ponteiro onde é guardado o passo em X.
+ * @param passoY Ponteiro onde é guardado o passo em Y.
+ * @return 1 em caso de sucesso, 0 se as duas posições forem iguais.
+ */
+int passoReta(int ax, int ay, int bx, int by, int* passoX, int* passoY) {
+    int dx = bx - ax;
+    int dy = by - ay;
+    int d = mdc(abs(dx), abs(dy));
+    if (d == 0) return 0;
+    *passoX = dx / d;
+    *passoY = dy / d;
+    return 1;
+}
+#pragma endregion
+
+#pragma region agruparPorFrequencia
+/**
+ * @brief Agrupa as antenas da lista por frequência num vetor contíguo.
+ * 
+ * É feita uma contagem por frequência seguida de uma soma prefixa, pelo que as antenas
+ * de cada frequência ficam seguidas no vetor devolvido. O grupo da frequência f ocupa
+ * as posições [inicio[f], inicio[f + 1]).
+ * 
+ * @param lista Lista ligada de antenas.
+ * @param inicio Vetor com 257 posições preenchido com o início de cada grupo.
+ * @return Vetor de ponteiros para as antenas agrupadas, ou NULL em caso de erro ou lista vazia.
+ */
+static Antena** agruparPorFrequencia(Antena* lista, int inicio[257]) {
+    int total = 0;
+    for (int f = 0; f <= 256; f++) inicio[f] = 0;
+    for (Antena* a = lista; a != NULL; a = a->prox) {
+        inicio[(unsigned char)a->frequencia + 1]++;
+        total++;
+    }
+    if (total == 0) return NULL;
+    for (int f = 0; f < 256; f++) inicio[f + 1] += inicio[f];
+
+    Antena** grupos = (Antena**)reservarMemoria(MEM_EFEITOS, (size_t)total * sizeof(Antena*));
+    if (grupos == NULL) return NULL;
+
+    int pos[256];
+    for (int f = 0; f < 256; f++) pos[f] = inicio[f];
+    for (Antena* a = lista; a != NULL; a = a->prox) {
+        grupos[pos[(unsigned char)a->frequencia]++] = a;
+    }
+    return grupos;
+}
+#pragma endregion
+
+#pragma region ContextoEfeitos
+/**
+ * @brief Registo temporário de um par de antenas que contribui para uma posição.
+ */
+typedef struct RegistoOrigem {
+    size_t celula;  /**< Posição no mapa (y * largura + x) */
+    Antena* a;      /**< Primeira antena do par */
+    Antena* b;      /**< Segunda antena do par */
+} RegistoOrigem;
+
+/**
+ * @brief Estado partilhado pelos motores de cálculo de efeitos.
+ */
+typedef struct ContextoEfeitos {
+    Efeito* efeitos;           /**< Lista de efeitos já encontrados */
+    uint64_t* grelha;          /**< Grelha de bits das posições já marcadas */
+    int largura;               /**< Largura do mapa */
+    int altura;                /**< Altura do mapa */
+    RegistoOrigem* registos;   /**< Pares registados (NULL se não forem pedidos) */
+    size_t numRegistos;        /**< Número de pares registados */
+    size_t capRegistos;        /**< Capacidade do vetor de registos */
+    int registar;              /**< 1 se as origens devem ser registadas */
+    int erro;                  /**< 1 se faltou memória (o cálculo é abandonado) */
+} ContextoEfeitos;
+#pragma endregion
+
+#pragma region marcarEfeito
+/**
+ * @brief Marca uma posição com efeito e, se pedido, regista o par que a originou.
+ * 
+ * A posição só é marcada na grelha depois de o efeito ser criado, pelo que uma falha de
+ * memória nunca deixa uma posição marcada sem efeito; nesse caso ctx->erro passa a 1.
+ * 
+ * @param ctx Contexto do cálculo.
+ * @param x Coordenada X (já validada dentro do mapa).
+ * @param y Coordenada Y (já validada dentro do mapa).
+ * @param a Primeira antena do par.
+ * @param b Segunda antena do par.
+ */
+static void marcarEfeito(ContextoEfeitos* ctx, int x, int y, Antena* a, Antena* b) {
+    if (ctx->erro) return;
+    size_t celula = (size_t)y * ctx->largura + x;
+    uint64_t bit = (uint64_t)1 << (celula & 63);
+    if (!(ctx->grelha[celula >> 6] & bit)) {
+        Efeito* novo = novoEfeito(ctx->efeitos, x, y);
+        if (novo == ctx->efeitos) {
+            ctx->erro = 1;
+            return;
+        }
+        ctx->efeitos = novo;
+        ctx->grelha[celula >> 6] |= bit;
+    }
+
+    if (!ctx->registar) return;
+    if (ctx->numRegistos == ctx->capRegistos) {
+        size_t novaCap = ctx->capRegistos ? ctx->capRegistos * 2 : 64;
+        if (novaCap > SIZE_MAX / sizeof(RegistoOrigem)) {
+            ctx->erro = 1;
+            return;
+        }
+        RegistoOrigem* novos = (RegistoOrigem*)redimensionarMemoria(MEM_EFEITOS, ctx->registos,
+                                                                   ctx->capRegistos * sizeof(RegistoOrigem),
+                                                                   novaCap * sizeof(RegistoOrigem));
+        if (novos == NULL) {
+            ctx->erro = 1;
+            return;
+        }
+        ctx->registos = novos;
+        ctx->capRegistos = novaCap;
+    }
+    ctx->registos[ctx->numRegistos].celula = celula;
+    ctx->registos[ctx->numRegistos].a = a;
+    ctx->registos[ctx->numRegistos].b = b;
+    ctx->numRegistos++;
+}
+#pragma endregion
+
+#pragma region RetaPar
+/**
+ * @brief Percurso da reta de um par de antenas dentro do mapa, nos dois sentidos.
+ */
+typedef struct RetaPar {
+    int x;          /**< Próxima posição X */
+    int y;          /**< Próxima posição Y */
+    int passoX;     /**< Passo em X no sentido atual */
+    int passoY;     /**< Passo em Y no sentido atual */
+    int origemX;    /**< Antena onde a reta começa (dentro do mapa) */
+    int origemY;
+    int sentido;    /**< 0 a caminho da outra antena, 1 no sentido oposto, 2 no fim */
+    int largura;    /**< Largura do mapa */
+    int altura;     /**< Altura do mapa */
+} RetaPar;
+
+/**
+ * @brief Prepara o percurso da reta de um par de antenas.
+ * 
+ * O vetor entre as antenas é reduzido pelo mdc (passoReta), obtendo-se o menor passo inteiro
+ * sobre a reta. A reta começa numa das antenas que esteja dentro do mapa e é percorrida
+ * primeiro na direção da outra antena e depois no sentido oposto, até sair do mapa.
+ * 
+ * @param r Percurso a preparar.
+ * @param largura Largura do mapa.
+ * @param altura Altura do mapa.
+ * @param ax Coordenada X da primeira antena.
+ * @param ay Coordenada Y da primeira antena.
+ * @param bx Coordenada X da segunda antena.
+ * @param by Coordenada Y da segunda antena.
+ * @return 1 se há posições a percorrer, 0 se as duas antenas estiverem fora do mapa
+ *         ou na mesma posição.
+ */
+static int iniciarRetaPar(RetaPar* r, int largura, int altura, int ax, int ay, int bx, int by) {
+    if (ax < 0 || ax >= largura || ay < 0 || ay >= altura) {
+        int tx = ax, ty = ay;
+        ax = bx;
+        ay = by;
+        bx = tx;
+        by = ty;
+    }
+    if (ax < 0 || ax >= largura || ay < 0 || ay >= altura) return 0;
+    if (!passoReta(ax, ay, bx, by, &r->passoX, &r->passoY)) return 0;
+
+    r->x = r->origemX = ax;
+    r->y = r->origemY = ay;
+    r->sentido = 0;
+    r->largura = largura;
+    r->altura = altura;
+    return 1;
+}
+
+/**
+ * @brief Avança para a próxima posição da reta dentro do mapa.
+ * 
+ * @param r Percurso preparado por iniciarRetaPar.
+ * @param x Onde é devolvida a coordenada X.
+ * @param y Onde é devolvida a coordenada Y.
+ * @return 1 se devolveu uma posição, 0 no fim da reta.
+ */
+static int proximaPosicaoReta(RetaPar* r, int* x, int* y) {
+    while (r->sentido < 2) {
+        if (r->x >= 0 && r->x < r->largura && r->y >= 0 && r->y < r->altura) {
+            *x = r->x;
+            *y = r->y;
+            r->x += r->passoX;
+            r->y += r->passoY;
+            return 1;
+        }
+        if (r->sentido++ == 0) {
+            r->passoX = -r->passoX;
+            r->passoY = -r->passoY;
+            r->x = r->origemX + r->passoX;
+            r->y = r->origemY + r->passoY;
+        }
+    }
+    return 0;
+}
+#pragma endregion
+
+#pragma region efeitosHarmonicos
+/**
+ * @brief Motor do modo harmónico: percorre a reta de cada par da mesma frequência.
+ * 
+ * A reta de cada par (a, b) é percorrida com iniciarRetaPar/proximaPosicaoReta, com o
+ * passo (b - a) reduzido pelo mdc, nos dois sentidos até aos limites do mapa.
+ * 
+ * @param ctx Contexto do cálculo.
+ * @param lista Lista ligada de antenas.
+ * @return 1 em caso de sucesso, 0 se faltou memória.
+ */
+static int efeitosHarmonicos(ContextoEfeitos* ctx, Antena* lista) {
+    int inicio[257];
+    Antena** grupos = agruparPorFrequencia(lista, inicio);
+    if (grupos == NULL) return lista == NULL;
+
+    for (int f = 0; f < 256 && !ctx->erro; f++) {
+        for (int i = inicio[f]; i < inicio[f + 1]; i++) {
+            for (int j = i + 1; j < inicio[f + 1]; j++) {
+                Antena* a = grupos[i];
+                Antena* b = grupos[j];
+                RetaPar reta;
+                int x, y;
+                if (!iniciarRetaPar(&reta, ctx->largura, ctx->altura, a->x, a->y, b->x, b->y)) continue;
+                while (!ctx->erro && proximaPosicaoReta(&reta, &x, &y)) marcarEfeito(ctx, x, y, a, b);
+            }
+        }
+    }
+
+    libertarMemoria(MEM_EFEITOS, grupos, (size_t)inicio[256] * sizeof(Antena*));
+    return 1;
+}
+#pragma endregion
+
+#pragma region efeitosPontoMedio
+/**
+ * @brief Motor do modo ponto médio: aplica calcularEfeito a cada par de antenas.
+ * 
+ * Produz as mesmas posições que deduzirEfeitosNefastos, mas cada par é analisado uma
+ * única vez e os duplicados são filtrados pela grelha de bits.
+ * 
+ * @param ctx Contexto do cálculo.
+ * @param lista Lista ligada de antenas.
+ * @return 1 em caso de sucesso.
+ */
+static int efeitosPontoMedio(ContextoEfeitos* ctx, Antena* lista) {
+    for (Antena* a = lista; a != NULL; a = a->prox) {
+        for (Antena* b = a->prox; b != NULL; b = b->prox) {
+            int x, y;
+            if (calcularEfeito(a, b, &x, &y) &&
+                x >= 0 && x < ctx->largura && y >= 0 && y < ctx->altura) {
+                marcarEfeito(ctx, x, y, a, b);
+            }
+        }
+    }
+    return 1;
+}
+#pragma endregion
+
+#pragma region construirOrigens
+/**
+ * @brief Converte os registos de pares numa tabela CSR indexada por efeito.
+ * 
+ * Cada posição com efeito recebe um índice compacto; os pares de cada efeito ficam
+ * seguidos no vetor de pares, entre inicio[i] e inicio[i + 1].
+ * 
+ * @param ctx Contexto do cálculo (com os registos preenchidos).
+ * @return Tabela de origens, ou NULL em caso de erro.
+ */
+static OrigensEfeitos* construirOrigens(ContextoEfeitos* ctx) {
+    size_t celulas = (size_t)ctx->largura * ctx->altura;
+    if (ctx->numRegistos > SIZE_MAX / sizeof(ParAntenas)) return NULL;
+    OrigensEfeitos* origens = (OrigensEfeitos*)reservarMemoriaZeros(MEM_EFEITOS, 1, sizeof(OrigensEfeitos));
+    if (origens == NULL) return NULL;
+    origens->largura = ctx->largura;
+    origens->altura = ctx->altura;
+    origens->indiceCelula = (uint32_t*)reservarMemoria(MEM_EFEITOS, celulas * sizeof(uint32_t));
+    if (origens->indiceCelula == NULL) {
+        limparOrigensEfeitos(origens);
+        return NULL;
+    }
+    for (size_t c = 0; c < celulas; c++) origens->indiceCelula[c] = ORIGEM_SEM_EFEITO;
+
+    // Índices compactos pela ordem do primeiro registo de cada posição
+    for (size_t r = 0; r < ctx->numRegistos; r++) {
+        size_t c = ctx->registos[r].celula;
+        if (origens->indiceCelula[c] != ORIGEM_SEM_EFEITO) continue;
+        if (origens->numEfeitos == ORIGEM_SEM_EFEITO - 1) { // O índice seguinte seria o marcador
+            limparOrigensEfeitos(origens);
+            return NULL;
+        }
+        origens->indiceCelula[c] = origens->numEfeitos++;
+    }
+
+    origens->inicio = (size_t*)reservarMemoriaZeros(MEM_EFEITOS, (size_t)origens->numEfeitos + 1, sizeof(size_t));
+    origens->numPares = ctx->numRegistos ? ctx->numRegistos : 1;
+    origens->pares = (ParAntenas*)reservarMemoria(MEM_EFEITOS, origens->numPares * sizeof(ParAntenas));
+    if (origens->inicio == NULL || origens->pares == NULL) {
+        limparOrigensEfeitos(origens);
+        return NULL;
+    }
+
+    // Contagem, soma prefixa e preenchimento
+    for (size_t r = 0; r < ctx->numRegistos; r++) {
+        origens->inicio[(size_t)origens->indiceCelula[ctx->registos[r].celula] + 1]++;
+    }
+    for (uint32_t i = 0; i < origens->numEfeitos; i++) {
+        origens->inicio[i + 1] += origens->inicio[i];
+    }
+    size_t tamPos = (size_t)(origens->numEfeitos ? origens->numEfeitos : 1) * sizeof(size_t);
+    size_t* pos = (size_t*)reservarMemoria(MEM_EFEITOS, tamPos);
+    if (pos == NULL) {
+        limparOrigensEfeitos(origens);
+        return NULL;
+    }
+    for (uint32_t i = 0; i < origens->numEfeitos; i++) pos[i] = origens->inicio[i];
+    for (size_t r = 0; r < ctx->numRegistos; r++) {
+        uint32_t e = origens->indiceCelula[ctx->registos[r].celula];
+        origens->pares[pos[e]].a = ctx->registos[r].a;
+        origens->pares[pos[e]].b = ctx->registos[r].b;
+        pos[e]++;
+    }
+    libertarMemoria(MEM_EFEITOS, pos, tamPos);
+
+    return origens;
+}
+#pragma endregion
+
+#pragma region deduzirEfeitosComOrigens
+/**
+ * @brief Calcula os efeitos no modo pedido e, opcionalmente, a tabela de origens.
+ * 
+ * @param lista Lista ligada de antenas.
+ * @param largura Largura do mapa.
+ * @param altura Altura do mapa.
+ * @param modo Modo de cálculo dos efeitos.
+ * @param origens Ponteiro onde é devolvida a tabela de origens, ou NULL para não a construir.
+ * @return Lista de efeitos (sem repetições), ou NULL se não houver efeitos ou faltar
+ *         memória. Em caso de erro nada é devolvido a meio (e *origens fica a NULL).
+ */
+Efeito* deduzirEfeitosComOrigens(Antena* lista, int largura, int altura, ModoEfeito modo,
+                                 OrigensEfeitos** origens) {
+    if (origens) *origens = NULL;
+    if (largura <= 0 || altura <= 0) return NULL;
+
+    ContextoEfeitos ctx = {0};
+    ctx.largura = largura;
+    ctx.altura = altura;
+    ctx.registar = origens != NULL;
+    size_t palavrasGrelha = ((size_t)largura * altura + 63) / 64;
+    ctx.grelha = (uint64_t*)reservarMemoriaZeros(MEM_EFEITOS, palavrasGrelha, sizeof(uint64_t));
+    if (ctx.grelha == NULL) return NULL;
+
+    int ok = modo == EFEITO_HARMONICO ? efeitosHarmonicos(&ctx, lista) : efeitosPontoMedio(&ctx, lista);
+    ok = ok && !ctx.erro;
+
+    if (ok && origens) {
+        *origens = construirOrigens(&ctx);
+        ok = *origens != NULL;
+    }
+
+    libertarMemoria(MEM_EFEITOS, ctx.registos, ctx.capRegistos * sizeof(RegistoOrigem));
+    libertarMemoria(MEM_EFEITOS, ctx.grelha, palavrasGrelha * sizeof(uint64_t));
+    if (!ok) {
+        limparEfeitos(ctx.efeitos);
+        return NULL;
+    }
+    return ctx.efeitos;
+}
+#pragma endregion
+
+#pragma region deduzirEfeitosHarmonicos
+/**
+ * @brief Gera a lista de efeitos harmónicos de todas as antenas até aos limites do mapa.
+ * 
+ * As antenas são agrupadas por frequência e apenas os pares do mesmo grupo são analisados.
+ * 
+ * @param lista Ponteiro para a lista de antenas.
+ * @param largura Largura do mapa.
+ * @param altura Altura do mapa.
+ * @return Retorna a lista de efeitos harmónicos gerados.
+ */
+Efeito* deduzirEfeitosHarmonicos(Antena* lista, int largura, int altura) {
+    return deduzirEfeitosComOrigens(lista, largura, altura, EFEITO_HARMONICO, NULL);
+}
+#pragma endregion
+
+#pragma region obterOrigensEfeito
+/**
+ * @brief Devolve os pares de antenas que originam o efeito numa posição.
+ * 
+ * @param origens Tabela de origens.
+ * @param x Coordenada X da posição.
+ * @param y Coordenada Y da posição.
+ * @param pares Ponteiro onde é devolvido o início dos pares (pode ser NULL).
+ * @return Número de pares que originam o efeito (0 se a posição não tiver efeito).
+ */
+size_t obterOrigensEfeito(const OrigensEfeitos* origens, int x, int y, const ParAntenas** pares) {
+    if (pares) *pares = NULL;
+    if (!origens || x < 0 || x >= origens->largura || y < 0 || y >= origens->altura) return 0;
+
+    uint32_t e = origens->indiceCelula[(size_t)y * origens->largura + x];
+    if (e == ORIGEM_SEM_EFEITO) return 0;
+
+    if (pares) *pares = &origens->pares[origens->inicio[e]];
+    return origens->inicio[e + 1] - origens->inicio[e];
+}
+#pragma endregion
+
+#pragma region sugerirRemocao
+/**
+ * @brief Procura uma antena cuja remoção elimina o efeito numa posição.
+ * 
+ * Uma antena serve se participar em todos os pares que originam o efeito.
+ * 
+ * @param origens Tabela de origens.
+ * @param x Coordenada X da posição.
+ * @param y Coordenada Y da posição.
+ * @return Antena a remover, ou NULL se não houver efeito ou nenhuma antena chegar.
+ */
+Antena* sugerirRemocao(const OrigensEfeitos* origens, int x, int y) {
+    const ParAntenas* pares;
+    size_t n = obterOrigensEfeito(origens, x, y, &pares);
+    if (n == 0) return NULL;
+
+    // Só as antenas do primeiro par podem estar em todos os pares
+    Antena* candidatas[2] = { pares[0].a, pares[0].b };
+    for (int c = 0; c < 2; c++) {
+        int todos = 1;
+        for (size_t i = 1; i < n && todos; i++) {
+            todos = pares[i].a == candidatas[c] || pares[i].b == candidatas[c];
+        }
+        if (todos) return candidatas[c];
+    }
+    return NULL;
+}
+#pragma endregion
+
+#pragma region limparOrigensEfeitos
+/**
+ * @brief Liberta a memória de uma tabela de origens.
+ * 
+ * @param origens Tabela de origens (pode ser NULL).
+ */
+void limparOrigensEfeitos(OrigensEfeitos* origens) {
+    if (!origens) return;
+    libertarMemoria(MEM_EFEITOS, origens->indiceCelula, (size_t)origens->largura * origens->altura * sizeof(uint32_t));
+    libertarMemoria(MEM_EFEITOS, origens->inicio, ((size_t)origens->numEfeitos + 1) * sizeof(size_t));
+    libertarMemoria(MEM_EFEITOS, origens->pares, origens->numPares * sizeof(ParAntenas));
+    libertarMemoria(MEM_EFEITOS, origens, sizeof(OrigensEfeitos));
+}
+#pragma endregion
+
+#pragma region criarConjuntoEfeitos
+/**
+ * @brief Cria um conjunto de efeitos harmónicos vazio.
+ * 
+ * @param largura Largura do mapa.
+ * @param altura Altura do mapa.
+ * @return Conjunto vazio, ou NULL em caso de erro.
+ */
+ConjuntoEfeitos* criarConjuntoEfeitos(int largura, int altura) {
+    if (largura < 0 || altura < 0 || (uint64_t)largura * altura >= UINT32_MAX) return NULL;
+
+    ConjuntoEfeitos* conjunto = (ConjuntoEfeitos*)reservarMemoriaZeros(MEM_EFEITOS, 1, sizeof(ConjuntoEfeitos));
+    if (conjunto == NULL) return NULL;
+    conjunto->largura = largura;
+    conjunto->altura = altura;
+
+    size_t celulas = (size_t)largura * altura;
+    conjunto->contagens = (uint32_t*)reservarMemoriaZeros(MEM_EFEITOS, celulas ? celulas : 1, sizeof(uint32_t));
+    conjunto->posicoes = (uint32_t*)reservarMemoria(MEM_EFEITOS, (celulas ? celulas : 1) * sizeof(uint32_t));
+    if (conjunto->contagens == NULL || conjunto->posicoes == NULL) {
+        libertarConjuntoEfeitos(conjunto);
+        return NULL;
+    }
+    return conjunto;
+}
+#pragma endregion
+
+#pragma region conjuntoAdicionarPar
+/**
+ * @brief Percorre a reta de um par, somando delta à contagem de cada posição.
+ * 
+ * A reta é percorrida com iniciarRetaPar/proximaPosicaoReta, como em efeitosHarmonicos.
+ * 
+ * @param conjunto Conjunto de efeitos (com capacidade para a reta inteira, se delta > 0).
+ * @param ax Coordenada X da primeira antena.
+ * @param ay Coordenada Y da primeira antena.
+ * @param bx Coordenada X da segunda antena.
+ * @param by Coordenada Y da segunda antena.
+ * @param delta +1 para acrescentar o par, -1 para o retirar.
+ */
+static void percorrerPar(ConjuntoEfeitos* conjunto, int ax, int ay, int bx, int by, int delta) {
+    RetaPar reta;
+    int x, y;
+    if (!iniciarRetaPar(&reta, conjunto->largura, conjunto->altura, ax, ay, bx, by)) return;
+
+    while (proximaPosicaoReta(&reta, &x, &y)) {
+        uint32_t celula = (uint32_t)y * conjunto->largura + x;
+        if (delta > 0) {
+            if (conjunto->contagens[celula]++ == 0) {
+                conjunto->posicoes[celula] = conjunto->numEfeitos;
+                conjunto->celulas[conjunto->numEfeitos++] = celula;
+            }
+        } else if (conjunto->contagens[celula] > 0 && --conjunto->contagens[celula] == 0) {
+            // Troca com a última célula do vetor denso
+            uint32_t ultima = conjunto->celulas[--conjunto->numEfeitos];
+            conjunto->celulas[conjunto->posicoes[celula]] = ultima;
+            conjunto->posicoes[ultima] = conjunto->posicoes[celula];
+        }
+    }
+}
+
+/**
+ * @brief Acrescenta ao conjunto as posições da reta de um par de antenas.
+ * 
+ * A capacidade do vetor denso é garantida antes de percorrer a reta (uma reta tem no máximo
+ * max(largura, altura) posições), pelo que a operação nunca fica a meio.
+ * 
+ * @param conjunto Conjunto de efeitos.
+ * @param ax Coordenada X da primeira antena.
+ * @param ay Coordenada Y da primeira antena.
+ * @param bx Coordenada X da segunda antena.
+ * @param by Coordenada Y da segunda antena.
+ * @return 1 em caso de sucesso, 0 se faltar memória (o conjunto fica inalterado).
+ */
+int conjuntoAdicionarPar(ConjuntoEfeitos* conjunto, int ax, int ay, int bx, int by) {
+    if (conjunto == NULL) return 0;
+
+    uint32_t maxReta = (uint32_t)(conjunto->largura > conjunto->altura ? conjunto->largura : conjunto->altura);
+    uint32_t celulas = (uint32_t)conjunto->largura * conjunto->altura;
+    uint32_t necessario = conjunto->numEfeitos + maxReta;
+    if (necessario > celulas) necessario = celulas;
+    if (necessario > conjunto->capacidade) {
+        uint32_t novaCap = conjunto->capacidade ? conjunto->capacidade : 64;
+        while (novaCap < necessario) novaCap = novaCap > celulas / 2 ? celulas : novaCap * 2;
+        uint32_t* novas = (uint32_t*)redimensionarMemoria(MEM_EFEITOS, conjunto->celulas,
+                                                          conjunto->capacidade * sizeof(uint32_t),
+                                                          novaCap * sizeof(uint32_t));
+        if (novas == NULL) return 0;
+        conjunto->celulas = novas;
+        conjunto->capacidade = novaCap;
+    }
+
+    percorrerPar(conjunto, ax, ay, bx, by, 1);
+    return 1;
+}
+#pragma endregion
+
+#pragma region conjuntoRemoverPar
+/**
+ * @brief Retira do conjunto a reta de um par de antenas acrescentado antes.
+ * 
+ * @param conjunto Conjunto de efeitos.
+ * @param ax Coordenada X da primeira antena.
+ * @param ay Coordenada Y da primeira antena.
+ * @param bx Coordenada X da segunda antena.
+ * @param by Coordenada Y da segunda antena.
+ */
+void conjuntoRemoverPar(ConjuntoEfeitos* conjunto, int ax, int ay, int bx, int by) {
+    if (conjunto == NULL) return;
+    percorrerPar(conjunto, ax, ay, bx, by, -1);
+}
+#pragma endregion
+
+#pragma region conjuntoParaLista
+/**
+ * @brief Produz a lista ligada das posições com efeito do conjunto.
+ * 
+ * @param conjunto Conjunto de efeitos.
+ * @return Lista de efeitos (NULL se estiver vazio ou faltar memória).
+ */
+Efeito* conjuntoParaLista(const ConjuntoEfeitos* conjunto) {
+    if (conjunto == NULL) return NULL;
+
+    Efeito* lista = NULL;
+    for (uint32_t i = 0; i < conjunto->numEfeitos; i++) {
+        uint32_t celula = conjunto->celulas[i];
+        Efeito* novo = novoEfeito(lista, (int)(celula % conjunto->largura), (int)(celula / conjunto->largura));
+        if (novo == lista) {
+            limparEfeitos(lista);
+            return NULL;
+        }
+        lista = novo;
+    }
+    return lista;
+}
+#pragma endregion
+
+#pragma region libertarConjuntoEfeitos
+/**
+ * @brief Liberta a memória de um conjunto de efeitos.
+ * 
+ * @param conjunto Conjunto de efeitos.
+ */
+void libertarConjuntoEfeitos(ConjuntoEfeitos* conjunto) {
+    if (conjunto == NULL) return;
+    size_t celulas = (size_t)conjunto->largura * conjunto->altura;
+    if (celulas == 0) celulas = 1;
+    libertarMemoria(MEM_EFEITOS, conjunto->contagens, celulas * sizeof(uint32_t));
+    libertarMemoria(MEM_EFEITOS, conjunto->posicoes, celulas * sizeof(uint32_t));
+    libertarMemoria(MEM_EFEITOS, conjunto->celulas, conjunto->capacidade * sizeof(uint32_t));
+    libertarMemoria(MEM_EFEITOS, conjunto, sizeof(ConjuntoEfeitos));
+}
+#pragma endregion
+
 #pragma region listarEfeitos
 /**
  * @brief Exibe todos os efeitos nefastos encontrados na consola.
@@ -159,7 +814,7 @@ void limparEfeitos(Efeito* lista) {
     while (lista) {
         Efeito* temp = lista;  // Guarda o ponteiro do nó atual
         lista = lista->prox;  // Avança para o próximo nó
-        free(temp);  // Limpa a memória do nó atual
+        libertarMemoria(MEM_EFEITOS, temp, sizeof(Efeito));  // Limpa a memória do nó atual
     }
 }
 #pragma endregion
\ No newline at end of file
@@ -24,6 +24,63 @@ typedef struct Efeito {
     struct Efeito* prox;    /**< Ponteiro para o próximo nó da lista ligada */
 } Efeito;
 
+/**
+ * @enum ModoEfeito
+ * @brief Modos de cálculo dos efeitos nefastos.
+ */
+typedef enum ModoEfeito {
+    EFEITO_PONTO_MEDIO,  /**< Ponto médio de cada par alinhado (como deduzirEfeitosNefastos) */
+    EFEITO_HARMONICO     /**< Todas as posições da reta de cada par da mesma frequência */
+} ModoEfeito;
+
+/**
+ * @struct ParAntenas
+ * @brief Par de antenas que origina um efeito.
+ */
+typedef struct ParAntenas {
+    Antena* a;  /**< Primeira antena do par */
+    Antena* b;  /**< Segunda antena do par */
+} ParAntenas;
+
+#define ORIGEM_SEM_EFEITO UINT32_MAX /**< Índice das posições sem efeito em OrigensEfeitos */
+
+/**
+ * @struct OrigensEfeitos
+ * @brief Índice inverso das posições com efeito para os pares de antenas que as originam.
+ * 
+ * Os pares estão guardados em formato CSR: os pares do efeito i ocupam
+ * pares[inicio[i]] até pares[inicio[i + 1] - 1]. O índice i de cada posição
+ * é dado por indiceCelula[y * largura + x] (ORIGEM_SEM_EFEITO se a posição não tiver efeito).
+ * Os inícios são size_t porque os mapas grandes passam facilmente os 2^31 pares registados.
+ */
+typedef struct OrigensEfeitos {
+    int largura;           /**< Largura do mapa */
+    int altura;            /**< Altura do mapa */
+    uint32_t* indiceCelula;/**< Índice do efeito de cada posição, ou ORIGEM_SEM_EFEITO */
+    uint32_t numEfeitos;   /**< Número de posições com efeito */
+    size_t* inicio;        /**< Início dos pares de cada efeito (numEfeitos + 1 posições) */
+    ParAntenas* pares;     /**< Pares de antenas de todos os efeitos */
+    size_t numPares;       /**< Capacidade reservada para pares */
+} OrigensEfeitos;
+
+/**
+ * @struct ConjuntoEfeitos
+ * @brief Conjunto de efeitos harmónicos mantido de forma incremental.
+ * 
+ * Cada posição guarda o número de pares de antenas cuja reta passa por ela e tem efeito
+ * enquanto esse número for positivo. As posições com efeito estão também num vetor denso
+ * (remoção por troca com a última), para que a lista possa ser produzida sem percorrer o mapa.
+ */
+typedef struct ConjuntoEfeitos {
+    int largura;           /**< Largura do mapa */
+    int altura;            /**< Altura do mapa */
+    uint32_t* contagens;   /**< Pares cuja reta passa em cada posição (y * largura + x) */
+    uint32_t* posicoes;    /**< Posição de cada célula com efeito no vetor celulas */
+    uint32_t* celulas;     /**< Células com efeito */
+    uint32_t numEfeitos;   /**< Número de posições com efeito */
+    uint32_t capacidade;   /**< Capacidade do vetor celulas */
+} ConjuntoEfeitos;
+
 /**
  * @brief Deduz os efeitos nefastos com base nas posições das antenas.
  * 
@@ -35,6 +92,133 @@ typedef struct Efeito {
  */
 Efeito* deduzirEfeitosNefastos(Antena* lista);
 
+/**
+ * @brief Deduz os efeitos harmónicos até aos limites do mapa.
+ * 
+ * Para cada par de antenas com a mesma frequência, marca todas as posições inteiras
+ * da reta que passa pelas duas antenas (incluindo as próprias antenas) até sair do mapa.
+ * A reta é percorrida com o passo reduzido pelo máximo divisor comum e as posições
+ * repetidas são filtradas por uma grelha de bits com o tamanho do mapa.
+ * 
+ * @param lista Lista ligada de antenas.
+ * @param largura Largura do mapa.
+ * @param altura Altura do mapa.
+ * @return Lista ligada de efeitos harmónicos (sem repetições).
+ */
+Efeito* deduzirEfeitosHarmonicos(Antena* lista, int largura, int altura);
+
+/**
+ * @brief Calcula o menor passo inteiro sobre a reta que vai de (ax, ay) a (bx, by).
+ * 
+ * O vetor (b - a) é dividido pelo máximo divisor comum das suas componentes, pelo que
+ * as posições da reta são exatamente a + k * passo, para k inteiro. É o passo usado por
+ * todos os cálculos de efeitos harmónicos.
+ * 
+ * @param ax Coordenada X da primeira antena.
+ * @param ay Coordenada Y da primeira antena.
+ * @param bx Coordenada X da segunda antena.
+ * @param by Coordenada Y da segunda antena.
+ * @param passoX Ponteiro onde é guardado o passo em X.
+ * @param passoY Ponteiro onde é guardado o passo em Y.
+ * @return 1 em caso de sucesso, 0 se as duas posições forem iguais (não há reta).
+ */
+int passoReta(int ax, int ay, int bx, int by, int* passoX, int* passoY);
+
+/**
+ * @brief Deduz os efeitos no modo indicado e, opcionalmente, regista as suas origens.
+ * 
+ * Quando origens não é NULL, é construída uma tabela com todos os pares de antenas
+ * que contribuem para cada posição com efeito. As antenas referidas pela tabela
+ * pertencem à lista, que deve continuar válida enquanto a tabela for usada.
+ * 
+ * @param lista Lista ligada de antenas.
+ * @param largura Largura do mapa.
+ * @param altura Altura do mapa.
+ * @param modo Modo de cálculo dos efeitos.
+ * @param origens Ponteiro onde é devolvida a tabela de origens, ou NULL.
+ * @return Lista ligada de efeitos (sem repetições), ou NULL se não houver efeitos ou faltar
+ *         memória. Em caso de erro nada é devolvido a meio (e *origens fica a NULL).
+ */
+Efeito* deduzirEfeitosComOrigens(Antena* lista, int largura, int altura, ModoEfeito modo,
+                                 OrigensEfeitos** origens);
+
+/**
+ * @brief Obtém os pares de antenas que originam o efeito numa posição.
+ * 
+ * @param origens Tabela de origens.
+ * @param x Coordenada X da posição.
+ * @param y Coordenada Y da posição.
+ * @param pares Ponteiro onde é devolvido o primeiro par (pode ser NULL).
+ * @return Número de pares encontrados (0 se a posição não tiver efeito).
+ */
+size_t obterOrigensEfeito(const OrigensEfeitos* origens, int x, int y, const ParAntenas** pares);
+
+/**
+ * @brief Sugere uma antena cuja remoção elimina o efeito numa posição.
+ * 
+ * @param origens Tabela de origens.
+ * @param x Coordenada X da posição.
+ * @param y Coordenada Y da posição.
+ * @return Antena presente em todos os pares da posição, ou NULL se não existir.
+ */
+Antena* sugerirRemocao(const OrigensEfeitos* origens, int x, int y);
+
+/**
+ * @brief Liberta a memória de uma tabela de origens.
+ * 
+ * @param origens Tabela de origens.
+ */
+void limparOrigensEfeitos(OrigensEfeitos* origens);
+
+/**
+ * @brief Cria um conjunto de efeitos harmónicos vazio.
+ * 
+ * @param largura Largura do mapa.
+ * @param altura Altura do mapa.
+ * @return Conjunto vazio, ou NULL em caso de erro.
+ */
+ConjuntoEfeitos* criarConjuntoEfeitos(int largura, int altura);
+
+/**
+ * @brief Acrescenta ao conjunto as posições da reta de um par de antenas.
+ * 
+ * As posições são as que deduzirEfeitosHarmonicos marca para o mesmo par.
+ * 
+ * @param conjunto Conjunto de efeitos.
+ * @param ax Coordenada X da primeira antena.
+ * @param ay Coordenada Y da primeira antena.
+ * @param bx Coordenada X da segunda antena.
+ * @param by Coordenada Y da segunda antena.
+ * @return 1 em caso de sucesso, 0 se faltar memória (o conjunto fica inalterado).
+ */
+int conjuntoAdicionarPar(ConjuntoEfeitos* conjunto, int ax, int ay, int bx, int by);
+
+/**
+ * @brief Retira do conjunto a reta de um par de antenas acrescentado antes.
+ * 
+ * @param conjunto Conjunto de efeitos.
+ * @param ax Coordenada X da primeira antena.
+ * @param ay Coordenada Y da primeira antena.
+ * @param bx Coordenada X da segunda antena.
+ * @param by Coordenada Y da segunda antena.
+ */
+void conjuntoRemoverPar(ConjuntoEfeitos* conjunto, int ax, int ay, int bx, int by);
+
+/**
+ * @brief Produz a lista ligada das posições com efeito do conjunto.
+ * 
+ * @param conjunto Conjunto de efeitos.
+ * @return Lista de efeitos (NULL se estiver vazio ou faltar memória).
+ */
+Efeito* conjuntoParaLista(const ConjuntoEfeitos* conjunto);
+
+/**
+ * @brief Liberta a memória de um conjunto de efeitos.
+ * 
+ * @param conjunto Conjunto de efeitos.
+ */
+void libertarConjuntoEfeitos(ConjuntoEfeitos* conjunto);
+
 /**
  * @brief Lista todos os efeitos nefastos na consola.
  * 
@@ -9,6 +9,7 @@
 #include <stdio.h>
 #include "antenas/antenas.h"
 #include "efeitos/efeitos.h"
+#include "densidade/densidade.h"
 
 
 #define MAX_ANTENAS 100
@@ -36,6 +37,54 @@ int main() {
     efeitos = deduzirEfeitosNefastos(lista);
     printf("\n=== Efeitos Nefastos ===\n");
     listarEfeitos(efeitos);
+    if (ultimoErroMemoria() != MEMORIA_OK) {
+        printf("Aviso: faltou memoria durante o carregamento ou o calculo.\n");
+    }
+
+    // Efeitos harmónicos até aos limites do mapa
+    int largura, altura;
+    if (obterDimensoesMapa("antenas.txt", &largura, &altura)) {
+        OrigensEfeitos* origens = NULL;
+        Efeito* harmonicos = deduzirEfeitosComOrigens(lista, largura, altura, EFEITO_HARMONICO, &origens);
+        printf("\n=== Efeitos Harmonicos ===\n");
+        listarEfeitos(harmonicos);
+
+        // Origens do primeiro efeito harmónico
+        if (harmonicos && origens) {
+            const ParAntenas* pares;
+            size_t n = obterOrigensEfeito(origens, harmonicos->x, harmonicos->y, &pares);
+            printf("\n=== Origens de (%d, %d) ===\n", harmonicos->x, harmonicos->y);
+            for (size_t i = 0; i < n; i++) {
+                printf("%c (%d,%d) - %c (%d,%d)\n", pares[i].a->frequencia, pares[i].a->x, pares[i].a->y,
+                       pares[i].b->frequencia, pares[i].b->x, pares[i].b->y);
+            }
+            Antena* remover = sugerirRemocao(origens, harmonicos->x, harmonicos->y);
+            if (remover) {
+                printf("Remover %c (%d,%d) elimina o efeito.\n", remover->frequencia, remover->x, remover->y);
+            }
+        }
+        limparOrigensEfeitos(origens);
+
+        // Contagens por retângulo (metade superior esquerda do mapa)
+        ArmazemAntenas* armazem = criarArmazem(lista);
+        IndiceDensidade* densidade = criarIndiceDensidade(harmonicos, armazem, largura, altura,
+                                                          DENSIDADE_POR_FREQUENCIA);
+        if (densidade) {
+            int x1 = largura / 2 - 1, y1 = altura / 2 - 1;
+            printf("\n=== Densidade em (0,0)-(%d,%d) ===\n", x1, y1);
+            printf("Efeitos: %u (%.1f%%)\n", contarEfeitosRetangulo(densidade, 0, 0, x1, y1),
+                   100.0 * densidadeEfeitosRetangulo(densidade, 0, 0, x1, y1));
+            printf("Antenas: %u (A: %u, o: %u)\n", contarAntenasRetangulo(densidade, 0, 0, 0, x1, y1),
+                   contarAntenasRetangulo(densidade, 'A', 0, 0, x1, y1),
+                   contarAntenasRetangulo(densidade, 'o', 0, 0, x1, y1));
+        }
+        libertarIndiceDensidade(densidade);
+        libertarArmazem(armazem);
+        limparEfeitos(harmonicos);
+    }
+
+    printf("\n=== Memoria ===\n");
+    listarMemoria();
 
     /*
     // Fase 2 - Passar antenas da lista ligada para vetor
@@ -0,0 +1,274 @@
+/**
+ * @author Tomás Cerqueira Gomes (a31501@alunos.ipca.pt)
+ * @date 2025-05-18
+ * 
+ * @file memoria.c
+ * @brief Implementação da camada de reserva de memória com contabilização.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "memoria.h"
+
+#pragma region alocadorSistema
+/**
+ * @brief Alocador por omissão: malloc, realloc e free.
+ */
+static void* reservarSistema(size_t tamanho, void* contexto) {
+    (void)contexto;
+    return malloc(tamanho);
+}
+
+static void* reservarZerosSistema(size_t tamanho, void* contexto) {
+    (void)contexto;
+    return calloc(1, tamanho);
+}
+
+static void* redimensionarSistema(void* p, size_t antigo, size_t novo, void* contexto) {
+    (void)antigo;
+    (void)contexto;
+    return realloc(p, novo);
+}
+
+static void libertarSistema(void* p, size_t tamanho, void* contexto) {
+    (void)tamanho;
+    (void)contexto;
+    free(p);
+}
+
+static AlocadorMemoria alocador = { reservarSistema, redimensionarSistema, libertarSistema, NULL, reservarZerosSistema };
+#pragma endregion
+
+#pragma region contadores
+static atomic_size_t bytesEmUso[MEM_NUM_SUBSISTEMAS];
+static atomic_size_t objetosEmUso[MEM_NUM_SUBSISTEMAS];
+static atomic_size_t picoSubsistema[MEM_NUM_SUBSISTEMAS];
+static atomic_size_t totalEmUso;
+static atomic_size_t picoTotal;
+static atomic_size_t orcamento;
+static _Thread_local ErroMemoria ultimoErro = MEMORIA_OK;
+
+/**
+ * @brief Atualiza um pico se o novo valor for maior.
+ */
+static void atualizarPico(atomic_size_t* pico, size_t valor) {
+    size_t atual = atomic_load_explicit(pico, memory_order_relaxed);
+    while (valor > atual &&
+           !atomic_compare_exchange_weak_explicit(pico, &atual, valor, memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+/**
+ * @brief Contabiliza bytes a reservar, respeitando o orçamento.
+ * @return 1 se a reserva pode prosseguir, 0 se ultrapassaria o orçamento.
+ */
+static int contabilizar(SubsistemaMemoria s, size_t tamanho) {
+    size_t total = atomic_fetch_add_explicit(&totalEmUso, tamanho, memory_order_relaxed) + tamanho;
+    size_t limite = atomic_load_explicit(&orcamento, memory_order_relaxed);
+    if (limite != 0 && total > limite) {
+        atomic_fetch_sub_explicit(&totalEmUso, tamanho, memory_order_relaxed);
+        ultimoErro = MEMORIA_ORCAMENTO_EXCEDIDO;
+        return 0;
+    }
+    size_t bytes = atomic_fetch_add_explicit(&bytesEmUso[s], tamanho, memory_order_relaxed) + tamanho;
+    atualizarPico(&picoSubsistema[s], bytes);
+    atualizarPico(&picoTotal, total);
+    return 1;
+}
+
+/**
+ * @brief Desconta bytes libertados.
+ */
+static void descontar(SubsistemaMemoria s, size_t tamanho) {
+    atomic_fetch_sub_explicit(&bytesEmUso[s], tamanho, memory_order_relaxed);
+    atomic_fetch_sub_explicit(&totalEmUso, tamanho, memory_order_relaxed);
+}
+#pragma endregion
+
+#pragma region definirAlocador
+/**
+ * @brief Define o alocador usado pela biblioteca.
+ * @param novo Funções a usar, ou NULL para voltar a malloc/realloc/free/calloc.
+ */
+void definirAlocador(const AlocadorMemoria* novo) {
+    if (novo && novo->reservar && novo->redimensionar && novo->libertar) {
+        alocador = *novo;
+    } else {
+        alocador = (AlocadorMemoria){ reservarSistema, redimensionarSistema, libertarSistema, NULL, reservarZerosSistema };
+    }
+}
+#pragma endregion
+
+#pragma region definirOrcamentoMemoria
+/**
+ * @brief Define o número máximo de bytes em uso.
+ * @param bytes Orçamento em bytes (0 para não haver limite).
+ */
+void definirOrcamentoMemoria(size_t bytes) {
+    atomic_store(&orcamento, bytes);
+}
+#pragma endregion
+
+#pragma region reservarMemoria
+/**
+ * @brief Reserva memória para um subsistema, contabilizando-a.
+ * @param subsistema Subsistema a que a memória é atribuída.
+ * @param tamanho Número de bytes.
+ * @return Ponteiro para a memória, ou NULL.
+ */
+void* reservarMemoria(SubsistemaMemoria subsistema, size_t tamanho) {
+    if (!contabilizar(subsistema, tamanho)) return NULL;
+
+    void* p = alocador.reservar(tamanho, alocador.contexto);
+    if (p == NULL) {
+        descontar(subsistema, tamanho);
+        ultimoErro = MEMORIA_SEM_MEMORIA;
+        return NULL;
+    }
+    atomic_fetch_add_explicit(&objetosEmUso[subsistema], 1, memory_order_relaxed);
+    return p;
+}
+#pragma endregion
+
+#pragma region reservarMemoriaZeros
+/**
+ * @brief Reserva memória inicializada a zero para um vetor.
+ *
+ * Com o alocador por omissão usa calloc, que para blocos grandes recebe páginas já a zero
+ * do sistema sem as percorrer.
+ * @param subsistema Subsistema a que a memória é atribuída.
+ * @param n Número de elementos.
+ * @param tamanho Tamanho de cada elemento.
+ * @return Ponteiro para a memória, ou NULL.
+ */
+void* reservarMemoriaZeros(SubsistemaMemoria subsistema, size_t n, size_t tamanho) {
+    if (tamanho != 0 && n > (size_t)-1 / tamanho) {
+        ultimoErro = MEMORIA_SEM_MEMORIA;
+        return NULL;
+    }
+    size_t bytes = n * tamanho;
+    if (!alocador.reservarZeros) {
+        void* p = reservarMemoria(subsistema, bytes);
+        if (p != NULL) memset(p, 0, bytes);
+        return p;
+    }
+
+    if (!contabilizar(subsistema, bytes)) return NULL;
+    void* p = alocador.reservarZeros(bytes, alocador.contexto);
+    if (p == NULL) {
+        descontar(subsistema, bytes);
+        ultimoErro = MEMORIA_SEM_MEMORIA;
+        return NULL;
+    }
+    atomic_fetch_add_explicit(&objetosEmUso[subsistema], 1, memory_order_relaxed);
+    return p;
+}
+#pragma endregion
+
+#pragma region redimensionarMemoria
+/**
+ * @brief Altera o tamanho de um bloco de memória, contabilizando a diferença.
+ * @param subsistema Subsistema a que o bloco pertence.
+ * @param p Bloco atual (ou NULL).
+ * @param antigo Tamanho atual do bloco.
+ * @param novo Novo tamanho.
+ * @return Ponteiro para o bloco, ou NULL (o bloco original mantém-se).
+ */
+void* redimensionarMemoria(SubsistemaMemoria subsistema, void* p, size_t antigo, size_t novo) {
+    if (p == NULL) return reservarMemoria(subsistema, novo);
+
+    if (novo > antigo && !contabilizar(subsistema, novo - antigo)) return NULL;
+
+    void* q = alocador.redimensionar(p, antigo, novo, alocador.contexto);
+    if (q == NULL) {
+        if (novo > antigo) descontar(subsistema, novo - antigo);
+        ultimoErro = MEMORIA_SEM_MEMORIA;
+        return NULL;
+    }
+    if (novo < antigo) descontar(subsistema, antigo - novo);
+    return q;
+}
+#pragma endregion
+
+#pragma region libertarMemoria
+/**
+ * @brief Liberta um bloco de memória e desconta-o do seu subsistema.
+ * @param subsistema Subsistema a que o bloco pertence.
+ * @param p Bloco a libertar (ou NULL).
+ * @param tamanho Tamanho com que o bloco foi reservado.
+ */
+void libertarMemoria(SubsistemaMemoria subsistema, void* p, size_t tamanho) {
+    if (p == NULL) return;
+    alocador.libertar(p, tamanho, alocador.contexto);
+    descontar(subsistema, tamanho);
+    atomic_fetch_sub_explicit(&objetosEmUso[subsistema], 1, memory_order_relaxed);
+}
+#pragma endregion
+
+#pragma region ultimoErroMemoria
+/**
+ * @brief Devolve o último erro de reserva da thread atual.
+ * @return Código do erro.
+ */
+ErroMemoria ultimoErroMemoria(void) {
+    return ultimoErro;
+}
+
+/**
+ * @brief Limpa o último erro de reserva da thread atual.
+ */
+void limparErroMemoria(void) {
+    ultimoErro = MEMORIA_OK;
+}
+
+/**
+ * @brief Regista um erro de reserva na thread atual.
+ * @param erro Código do erro (MEMORIA_OK não altera o erro registado).
+ */
+void registarErroMemoria(ErroMemoria erro) {
+    if (erro != MEMORIA_OK) ultimoErro = erro;
+}
+#pragma endregion
+
+#pragma region obterEstatisticasMemoria
+/**
+ * @brief Obtém uma cópia dos contadores de memória.
+ * @param estatisticas Estrutura a preencher.
+ */
+void obterEstatisticasMemoria(EstatisticasMemoria* estatisticas) {
+    if (!estatisticas) return;
+    for (int s = 0; s < MEM_NUM_SUBSISTEMAS; s++) {
+        estatisticas->bytes[s] = atomic_load(&bytesEmUso[s]);
+        estatisticas->objetos[s] = atomic_load(&objetosEmUso[s]);
+        estatisticas->picoBytes[s] = atomic_load(&picoSubsistema[s]);
+    }
+    estatisticas->totalBytes = atomic_load(&totalEmUso);
+    estatisticas->picoTotal = atomic_load(&picoTotal);
+    estatisticas->orcamento = atomic_load(&orcamento);
+}
+#pragma endregion
+
+#pragma region listarMemoria
+/**
+ * @brief Mostra uma tabela com a memória em uso e os picos de cada subsistema.
+ */
+void listarMemoria(void) {
+    static const char* nomes[MEM_NUM_SUBSISTEMAS] = { "Antenas", "Efeitos", "Vertices", "Arestas", "Outros" };
+    EstatisticasMemoria e;
+    obterEstatisticasMemoria(&e);
+
+    printf("+------------+------------+----------+------------+\n");
+    printf("| Subsistema |   Bytes    | Objetos  |    Pico    |\n");
+    printf("+------------+------------+----------+------------+\n");
+    for (int s = 0; s < MEM_NUM_SUBSISTEMAS; s++) {
+        printf("| %-10s | %10zu | %8zu | %10zu |\n", nomes[s], e.bytes[s], e.objetos[s], e.picoBytes[s]);
+    }
+    printf("+------------+------------+----------+------------+\n");
+    printf("| Total      | %10zu |          | %10zu |\n", e.totalBytes, e.picoTotal);
+    printf("+------------+------------+----------+------------+\n");
+    if (e.orcamento) printf("Orcamento: %zu bytes\n", e.orcamento);
+}
+#pragma endregion
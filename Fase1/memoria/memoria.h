@@ -0,0 +1,146 @@
+/**
+ * @author Tomás Cerqueira Gomes (a31501@alunos.ipca.pt)
+ * @date 2025-05-18
+ * 
+ * @file memoria.h
+ * @brief Camada de reserva de memória com contabilização por subsistema e orçamento.
+*/
+
+#ifndef MEMORIA_H
+#define MEMORIA_H
+
+#include <stddef.h>
+
+/**
+ * @enum SubsistemaMemoria
+ * @brief Subsistemas a que é atribuída a memória reservada.
+ */
+typedef enum SubsistemaMemoria {
+    MEM_ANTENAS,   /**< Listas e armazéns de antenas */
+    MEM_EFEITOS,   /**< Listas de efeitos e tabelas de origens */
+    MEM_VERTICES,  /**< Vértices e índices do grafo */
+    MEM_ARESTAS,   /**< Arestas e vistas CSR */
+    MEM_OUTROS,    /**< Restantes estruturas */
+    MEM_NUM_SUBSISTEMAS
+} SubsistemaMemoria;
+
+/**
+ * @enum ErroMemoria
+ * @brief Códigos de erro da camada de memória.
+ */
+typedef enum ErroMemoria {
+    MEMORIA_OK = 0,              /**< Sem erro */
+    MEMORIA_SEM_MEMORIA,         /**< O alocador não conseguiu reservar a memória */
+    MEMORIA_ORCAMENTO_EXCEDIDO   /**< A reserva ultrapassaria o orçamento definido */
+} ErroMemoria;
+
+/**
+ * @struct AlocadorMemoria
+ * @brief Funções usadas para reservar e libertar a memória da biblioteca.
+ *
+ * O tamanho é sempre passado a libertar, o que permite usar alocadores por blocos.
+ * reservarZeros é opcional: sem ela, a memória é reservada com reservar e posta a zero com memset.
+ */
+typedef struct AlocadorMemoria {
+    void* (*reservar)(size_t tamanho, void* contexto);                          /**< Como malloc */
+    void* (*redimensionar)(void* p, size_t antigo, size_t novo, void* contexto); /**< Como realloc */
+    void (*libertar)(void* p, size_t tamanho, void* contexto);                  /**< Como free */
+    void* contexto;                                                             /**< Passado a todas as funções */
+    void* (*reservarZeros)(size_t tamanho, void* contexto);                     /**< Como calloc (pode ser NULL) */
+} AlocadorMemoria;
+
+/**
+ * @struct EstatisticasMemoria
+ * @brief Contadores de memória em uso e picos, por subsistema e no total.
+ */
+typedef struct EstatisticasMemoria {
+    size_t bytes[MEM_NUM_SUBSISTEMAS];      /**< Bytes em uso */
+    size_t objetos[MEM_NUM_SUBSISTEMAS];    /**< Blocos em uso */
+    size_t picoBytes[MEM_NUM_SUBSISTEMAS];  /**< Maior número de bytes em uso */
+    size_t totalBytes;                      /**< Bytes em uso em todos os subsistemas */
+    size_t picoTotal;                       /**< Maior total de bytes em uso */
+    size_t orcamento;                       /**< Orçamento definido (0 se não houver) */
+} EstatisticasMemoria;
+
+/**
+ * @brief Define o alocador usado pela biblioteca.
+ *
+ * Deve ser chamada antes de qualquer reserva, já que a memória tem de ser libertada
+ * pelo mesmo alocador que a reservou.
+ * @param alocador Funções a usar, ou NULL para voltar a malloc/realloc/free/calloc.
+ */
+void definirAlocador(const AlocadorMemoria* alocador);
+
+/**
+ * @brief Define o número máximo de bytes em uso em todos os subsistemas.
+ * @param bytes Orçamento em bytes (0 para não haver limite).
+ */
+void definirOrcamentoMemoria(size_t bytes);
+
+/**
+ * @brief Reserva memória para um subsistema.
+ * @param subsistema Subsistema a que a memória é atribuída.
+ * @param tamanho Número de bytes.
+ * @return Ponteiro para a memória, ou NULL (ver ultimoErroMemoria).
+ */
+void* reservarMemoria(SubsistemaMemoria subsistema, size_t tamanho);
+
+/**
+ * @brief Reserva memória inicializada a zero para um vetor.
+ * @param subsistema Subsistema a que a memória é atribuída.
+ * @param n Número de elementos.
+ * @param tamanho Tamanho de cada elemento.
+ * @return Ponteiro para a memória, ou NULL (ver ultimoErroMemoria).
+ */
+void* reservarMemoriaZeros(SubsistemaMemoria subsistema, size_t n, size_t tamanho);
+
+/**
+ * @brief Altera o tamanho de um bloco de memória.
+ * @param subsistema Subsistema a que o bloco pertence.
+ * @param p Bloco atual (ou NULL).
+ * @param antigo Tamanho atual do bloco (0 se p for NULL).
+ * @param novo Novo tamanho.
+ * @return Ponteiro para o bloco, ou NULL (o bloco original mantém-se).
+ */
+void* redimensionarMemoria(SubsistemaMemoria subsistema, void* p, size_t antigo, size_t novo);
+
+/**
+ * @brief Liberta um bloco de memória reservado por esta camada.
+ * @param subsistema Subsistema a que o bloco pertence.
+ * @param p Bloco a libertar (ou NULL).
+ * @param tamanho Tamanho com que o bloco foi reservado.
+ */
+void libertarMemoria(SubsistemaMemoria subsistema, void* p, size_t tamanho);
+
+/**
+ * @brief Devolve o último erro de reserva da thread atual.
+ * @return Código do erro (MEMORIA_OK se não houve erros desde a última limpeza).
+ */
+ErroMemoria ultimoErroMemoria(void);
+
+/**
+ * @brief Limpa o último erro de reserva da thread atual.
+ */
+void limparErroMemoria(void);
+
+/**
+ * @brief Regista um erro de reserva na thread atual.
+ *
+ * Permite que quem espera por threads auxiliares veja os erros que nelas ocorreram
+ * (o último erro é guardado por thread).
+ * @param erro Código do erro (MEMORIA_OK não altera o erro registado).
+ */
+void registarErroMemoria(ErroMemoria erro);
+
+/**
+ * @brief Obtém uma cópia dos contadores de memória.
+ * @param estatisticas Estrutura a preencher.
+ */
+void obterEstatisticasMemoria(EstatisticasMemoria* estatisticas);
+
+/**
+ * @brief Mostra uma tabela com a memória em uso e os picos de cada subsistema.
+ */
+void listarMemoria(void);
+
+#endif
@@ -0,0 +1,316 @@
+/**
+ * @author Tomás Cerqueira Gomes (a31501@alunos.ipca.pt)
+ * @date 2025-05-18
+ *
+ * @file construcao.c
+ * @brief Implementação da construção do grafo em paralelo (contagem, soma prefixa e escrita).
+*/
+
+#include "construcao.h"
+#include "paralelo.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define CUSTO_POR_THREAD 65536 //Custo mínimo (linhas x tamanho do grupo) que justifica mais uma thread
+
+#pragma region ConstrucaoCSR
+/**
+ * @brief Estado partilhado da construção da vista CSR.
+ */
+typedef struct ConstrucaoCSR {
+    const ArmazemAntenas* antenas; //Armazém de antenas
+    GrafoCSR* csr; //Vista em construção
+    const uint32_t* grupos; //Índices agrupados por frequência
+    const uint32_t* inicioGrupo; //Início de cada grupo (257 posições)
+    float* gx; //Coordenada X de cada posição de grupos
+    float* gy; //Coordenada Y de cada posição de grupos
+    uint32_t* limites; //Posições de grupos atribuídas a cada thread (numThreads + 1)
+    uint64_t* somas; //Soma dos graus do bloco de índices de cada thread
+} ConstrucaoCSR;
+
+/**
+ * @brief Primeira posição de grupos cujo custo acumulado chega ao alvo.
+ *
+ * O custo de uma linha é o tamanho do seu grupo, pelo que um grupo de s antenas custa s x s.
+ */
+static uint32_t posicaoDoCusto(const uint32_t inicioGrupo[257], uint64_t alvo) {
+    uint64_t acumulado = 0;
+    for (int f = 0; f < 256; f++) {
+        uint64_t s = inicioGrupo[f + 1] - inicioGrupo[f];
+        if (s == 0) continue;
+        if (acumulado + s * s >= alvo) {
+            return inicioGrupo[f] + (uint32_t)((alvo - acumulado + s - 1) / s);
+        }
+        acumulado += s * s;
+    }
+    return inicioGrupo[256];
+}
+
+/**
+ * @brief Frequência (grupo) a que pertence uma posição de grupos.
+ */
+static int grupoDaPosicao(const uint32_t inicioGrupo[257], uint32_t p) {
+    int f = 0;
+    while (f < 255 && inicioGrupo[f + 1] <= p) f++;
+    return f;
+}
+
+/**
+ * @brief Conta as arestas das linhas desta thread e copia as coordenadas do seu bloco de grupos.
+ */
+static void contarLinhas(int id, int numThreads, void* arg) {
+    ConstrucaoCSR* c = arg;
+    (void)numThreads;
+    uint32_t p = c->limites[id], fim = c->limites[id + 1];
+    int f = grupoDaPosicao(c->inicioGrupo, p);
+    while (p < fim) {
+        while (c->inicioGrupo[f + 1] <= p) f++;
+        uint32_t s = c->inicioGrupo[f + 1] - c->inicioGrupo[f];
+        uint32_t fimGrupo = c->inicioGrupo[f + 1] < fim ? c->inicioGrupo[f + 1] : fim;
+        for (; p < fimGrupo; p++) {
+            uint32_t i = c->grupos[p];
+            c->csr->inicio[i + 1] = s - 1;
+            c->gx[p] = (float)armazemX(c->antenas, i);
+            c->gy[p] = (float)armazemY(c->antenas, i);
+        }
+    }
+}
+
+/**
+ * @brief Soma prefixa, primeira passagem: soma os graus do bloco de índices desta thread.
+ */
+static void somarBloco(int id, int numThreads, void* arg) {
+    ConstrucaoCSR* c = arg;
+    uint32_t n = c->csr->numVertices;
+    uint32_t a = (uint32_t)((uint64_t)n * id / numThreads), b = (uint32_t)((uint64_t)n * (id + 1) / numThreads);
+    uint64_t soma = 0;
+    for (uint32_t i = a; i < b; i++) soma += c->csr->inicio[i + 1];
+    c->somas[id] = soma;
+}
+
+/**
+ * @brief Soma prefixa, segunda passagem: escreve o início das linhas do bloco a partir da soma anterior.
+ */
+static void acumularBloco(int id, int numThreads, void* arg) {
+    ConstrucaoCSR* c = arg;
+    uint32_t n = c->csr->numVertices;
+    uint32_t a = (uint32_t)((uint64_t)n * id / numThreads), b = (uint32_t)((uint64_t)n * (id + 1) / numThreads);
+    uint32_t acumulado = (uint32_t)c->somas[id];
+    for (uint32_t i = a; i < b; i++) {
+        acumulado += c->csr->inicio[i + 1];
+        c->csr->inicio[i + 1] = acumulado;
+    }
+}
+
+/**
+ * @brief Escreve as arestas das linhas desta thread nas suas posições finais.
+ */
+static void escreverLinhas(int id, int numThreads, void* arg) {
+    ConstrucaoCSR* c = arg;
+    (void)numThreads;
+    uint32_t p = c->limites[id], fim = c->limites[id + 1];
+    int f = grupoDaPosicao(c->inicioGrupo, p);
+    while (p < fim) {
+        while (c->inicioGrupo[f + 1] <= p) f++;
+        uint32_t g0 = c->inicioGrupo[f], g1 = c->inicioGrupo[f + 1];
+        uint32_t fimGrupo = g1 < fim ? g1 : fim;
+        for (; p < fimGrupo; p++) {
+            uint32_t pos = c->csr->inicio[c->grupos[p]];
+            uint32_t* destinos = c->csr->destinos;
+            float* distancias = c->csr->distancias;
+            float x = c->gx[p], y = c->gy[p];
+            for (uint32_t q = g0; q < g1; q++) {
+                if (q == p) continue;
+                float dx = x - c->gx[q];
+                float dy = y - c->gy[q];
+                destinos[pos] = c->grupos[q];
+                distancias[pos] = sqrtf(dx * dx + dy * dy);
+                pos++;
+            }
+        }
+    }
+}
+#pragma endregion
+
+#pragma region construirCSRParalelo
+/**
+ * @brief Constrói em paralelo a vista CSR do grafo de grupos de frequência.
+ * @param antenas Armazém de antenas.
+ * @param numThreads Número de threads (valores <= 0 usam os processadores disponíveis).
+ * @return Vista CSR, ou NULL em caso de erro.
+ */
+GrafoCSR* construirCSRParalelo(const ArmazemAntenas* antenas, int numThreads) {
+    if (!antenas) return NULL;
+
+    uint32_t inicioGrupo[257];
+    uint32_t* grupos = armazemAgruparPorFrequencia(antenas, inicioGrupo);
+    if (!grupos) return NULL;
+
+    // Custo total e número de threads (entradas pequenas não compensam o arranque das threads)
+    uint64_t custoTotal = 0;
+    for (int f = 0; f < 256; f++) {
+        uint64_t s = inicioGrupo[f + 1] - inicioGrupo[f];
+        custoTotal += s * s;
+    }
+    if (numThreads <= 0) numThreads = numeroThreads();
+    if ((uint64_t)numThreads > 1 + custoTotal / CUSTO_POR_THREAD) numThreads = (int)(1 + custoTotal / CUSTO_POR_THREAD);
+
+    uint32_t m = inicioGrupo[256];
+    ConstrucaoCSR c = { .antenas = antenas, .grupos = grupos, .inicioGrupo = inicioGrupo };
+    size_t tamCoordenadas = (m ? m : 1) * sizeof(float);
+    c.gx = reservarMemoria(MEM_OUTROS, tamCoordenadas);
+    c.gy = reservarMemoria(MEM_OUTROS, tamCoordenadas);
+    c.limites = reservarMemoria(MEM_OUTROS, (numThreads + 1) * sizeof(uint32_t));
+    c.somas = reservarMemoria(MEM_OUTROS, numThreads * sizeof(uint64_t));
+    c.csr = reservarMemoriaZeros(MEM_ARESTAS, 1, sizeof(GrafoCSR));
+    if (c.csr) {
+        c.csr->numVertices = antenas->total;
+        c.csr->inicio = reservarMemoriaZeros(MEM_ARESTAS, (size_t)antenas->total + 1, sizeof(uint32_t));
+    }
+    int ok = c.gx && c.gy && c.limites && c.somas && c.csr && c.csr->inicio;
+
+    if (ok) {
+        // Blocos contíguos de linhas com custo semelhante
+        for (int t = 0; t <= numThreads; t++) {
+            c.limites[t] = posicaoDoCusto(inicioGrupo, custoTotal * t / numThreads);
+        }
+        c.limites[0] = 0;
+        c.limites[numThreads] = m;
+
+        executarParalelo(numThreads, contarLinhas, &c);
+        executarParalelo(numThreads, somarBloco, &c);
+        uint64_t acumulado = 0;
+        for (int t = 0; t < numThreads; t++) {
+            uint64_t soma = c.somas[t];
+            c.somas[t] = acumulado;
+            acumulado += soma;
+        }
+        ok = acumulado <= UINT32_MAX;
+    }
+    if (ok) {
+        executarParalelo(numThreads, acumularBloco, &c);
+        c.csr->numArestas = c.csr->inicio[antenas->total];
+        size_t tamArestas = c.csr->numArestas ? c.csr->numArestas : 1;
+        c.csr->destinos = reservarMemoria(MEM_ARESTAS, tamArestas * sizeof(uint32_t));
+        c.csr->distancias = reservarMemoria(MEM_ARESTAS, tamArestas * sizeof(float));
+        ok = c.csr->destinos && c.csr->distancias;
+    }
+    if (ok) executarParalelo(numThreads, escreverLinhas, &c);
+
+    libertarGruposFrequencia(grupos, inicioGrupo);
+    libertarMemoria(MEM_OUTROS, c.gx, tamCoordenadas);
+    libertarMemoria(MEM_OUTROS, c.gy, tamCoordenadas);
+    libertarMemoria(MEM_OUTROS, c.limites, (numThreads + 1) * sizeof(uint32_t));
+    libertarMemoria(MEM_OUTROS, c.somas, numThreads * sizeof(uint64_t));
+    if (!ok) {
+        libertarCSR(c.csr);
+        return NULL;
+    }
+    return c.csr;
+}
+#pragma endregion
+
+#pragma region construirGrafoParalelo
+/**
+ * @brief Estado partilhado da conversão da vista CSR em listas de adjacência.
+ */
+typedef struct ConversaoListas {
+    GR* grafo; //Grafo com os vértices já criados
+    const GrafoCSR* csr; //Arestas a converter
+    uint32_t* limites; //Índices atribuídos a cada thread (numThreads + 1)
+    atomic_int erro; //1 se faltou memória
+} ConversaoListas;
+
+/**
+ * @brief Cria as listas de adjacência dos índices desta thread.
+ *
+ * As arestas de cada linha são percorridas do fim para o início e inseridas à cabeça,
+ * para que a lista fique pela ordem da vista CSR.
+ */
+static void converterLinhas(int id, int numThreads, void* arg) {
+    ConversaoListas* c = arg;
+    (void)numThreads;
+    const GrafoCSR* csr = c->csr;
+    Vertice** porIndice = c->grafo->porIndice;
+    for (uint32_t i = c->limites[id]; i < c->limites[id + 1]; i++) {
+        Vertice* v = porIndice[i];
+        if (!v) continue;
+        for (uint32_t e = csr->inicio[i + 1]; e > csr->inicio[i]; e--) {
+            if (atomic_load_explicit(&c->erro, memory_order_relaxed)) return;
+            Aresta* nova = reservarMemoria(MEM_ARESTAS, sizeof(Aresta));
+            if (!nova) {
+                atomic_store(&c->erro, 1);
+                return;
+            }
+            nova->distancia = csr->distancias[e - 1];
+            nova->destino = porIndice[csr->destinos[e - 1]];
+            nova->prox = v->adj;
+            v->adj = nova;
+        }
+    }
+}
+
+/**
+ * @brief Primeiro índice cujo custo acumulado (arestas + linhas) chega ao alvo.
+ */
+static uint32_t indiceDoCusto(const GrafoCSR* csr, uint64_t alvo) {
+    uint32_t a = 0, b = csr->numVertices;
+    while (a < b) {
+        uint32_t meio = a + (b - a) / 2;
+        if ((uint64_t)csr->inicio[meio] + meio < alvo) a = meio + 1;
+        else b = meio;
+    }
+    return a;
+}
+
+/**
+ * @brief Constrói em paralelo um grafo equivalente ao de construirGrafo.
+ * @param listaAntenas Lista ligada de antenas.
+ * @param numThreads Número de threads (valores <= 0 usam os processadores disponíveis).
+ * @return Ponteiro para o grafo construído, ou NULL em caso de erro.
+ */
+GR* construirGrafoParalelo(Antena* listaAntenas, int numThreads) {
+    ArmazemAntenas* antenas = criarArmazem(listaAntenas);
+    if (!antenas) return NULL;
+    GrafoCSR* csr = construirCSRParalelo(antenas, numThreads);
+    if (!csr) {
+        libertarArmazem(antenas);
+        return NULL;
+    }
+    GR* grafo = criarGrafoSemArestas(antenas);
+    if (!grafo) {
+        libertarCSR(csr);
+        libertarArmazem(antenas);
+        return NULL;
+    }
+
+    uint64_t custoTotal = (uint64_t)csr->numArestas + csr->numVertices;
+    if (numThreads <= 0) numThreads = numeroThreads();
+    if ((uint64_t)numThreads > 1 + custoTotal / CUSTO_POR_THREAD) numThreads = (int)(1 + custoTotal / CUSTO_POR_THREAD);
+
+    ConversaoListas c = { .grafo = grafo, .csr = csr };
+    atomic_init(&c.erro, 0);
+    c.limites = reservarMemoria(MEM_OUTROS, (numThreads + 1) * sizeof(uint32_t));
+    int ok;
+    if (c.limites) {
+        for (int t = 0; t <= numThreads; t++) {
+            c.limites[t] = indiceDoCusto(csr, custoTotal * t / numThreads);
+        }
+        c.limites[0] = 0;
+        c.limites[numThreads] = csr->numVertices;
+        executarParalelo(numThreads, converterLinhas, &c);
+        ok = !atomic_load(&c.erro);
+    } else {
+        ok = 0;
+    }
+
+    libertarMemoria(MEM_OUTROS, c.limites, (numThreads + 1) * sizeof(uint32_t));
+    libertarCSR(csr);
+    if (!ok) {
+        libertarGrafo(grafo);
+        return NULL;
+    }
+    return grafo;
+}
+#pragma endregion
@@ -0,0 +1,40 @@
+/**
+ * @author Tomás Cerqueira Gomes (a31501@alunos.ipca.pt)
+ * @date 2025-05-18
+ *
+ * @file construcao.h
+ * @brief Construção do grafo (LIGACAO_GRUPO) em paralelo.
+*/
+#ifndef CONSTRUCAO_H
+#define CONSTRUCAO_H
+
+#include "grafos.h"
+
+/**
+ * @brief Constrói em paralelo a vista CSR do grafo de grupos de frequência.
+ *
+ * As antenas são agrupadas por frequência e as linhas (uma por antena), pela ordem dos grupos,
+ * são repartidas em blocos contíguos de custo semelhante: os grupos pequenos ficam juntos e os
+ * grandes são divididos entre várias threads. Cada thread conta as arestas das suas linhas,
+ * uma soma prefixa em paralelo dá o início de cada linha e cada thread escreve depois as suas
+ * linhas diretamente na posição final. As arestas de cada linha ficam por ordem crescente do
+ * índice do destino, pelo que o resultado não depende do número de threads.
+ * @param antenas Armazém de antenas.
+ * @param numThreads Número de threads (valores <= 0 usam os processadores disponíveis).
+ * @return Vista CSR, ou NULL em caso de erro (ou se houver mais de 2^32 - 1 arestas).
+ */
+GrafoCSR* construirCSRParalelo(const ArmazemAntenas* antenas, int numThreads);
+
+/**
+ * @brief Constrói em paralelo um grafo equivalente ao de construirGrafo.
+ *
+ * As arestas são calculadas por construirCSRParalelo e depois convertidas, também em paralelo,
+ * nas listas de adjacência dos vértices (por ordem crescente do índice do destino).
+ * A vista CSR é a forma que melhor escala: a conversão reserva cada aresta em separado.
+ * @param listaAntenas Lista ligada de antenas.
+ * @param numThreads Número de threads (valores <= 0 usam os processadores disponíveis).
+ * @return Ponteiro para o grafo construído, ou NULL em caso de erro.
+ */
+GR* construirGrafoParalelo(Antena* listaAntenas, int numThreads);
+
+#endif
@@ -9,22 +9,24 @@
 #include "grafos.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
 #define MAX_FILA 100
+#define SEM_ANTERIOR UINT32_MAX //Valor de anteriorIndice no primeiro vértice da lista
 
 #pragma region inserirVertice
 /**
  * @brief Insere um novo vértice (antena) na lista de vértices do grafo.
  * @param lista Lista ligada de vértices.
- * @param a Estrutura Antena a ser inserida.
+ * @param antena Índice da antena no armazém do grafo.
  * @return Ponteiro para o novo vértice inserido.
  */
-Vertice* inserirVertice(Vertice* lista, Antena a) {
-    Vertice* novo = malloc(sizeof(Vertice));
+Vertice* inserirVertice(Vertice* lista, uint32_t antena) {
+    Vertice* novo = reservarMemoria(MEM_VERTICES, sizeof(Vertice));
     if (!novo) return lista;
 
-    novo->info = a;
+    novo->antena = antena;
     novo->adj = NULL;
     novo->proximo = lista;
     novo->visitado = 0;
@@ -32,67 +34,1108 @@ Vertice* inserirVertice(Vertice* lista, Antena a) {
 }
 #pragma endregion
 
+#pragma region distanciaPontos
+/**
+ * @brief Calcula a distância euclidiana entre duas posições do mapa.
+ * @param ax Coordenada X da primeira posição.
+ * @param ay Coordenada Y da primeira posição.
+ * @param bx Coordenada X da segunda posição.
+ * @param by Coordenada Y da segunda posição.
+ * @return Distância entre as duas posições.
+ */
+float distanciaPontos(int ax, int ay, int bx, int by) {
+    float dx = (float)ax - (float)bx;
+    float dy = (float)ay - (float)by;
+    return sqrtf(dx * dx + dy * dy);
+}
+#pragma endregion
+
+#pragma region calcularDistancia
+/**
+ * @brief Calcula a distância euclidiana entre duas antenas do armazém.
+ * @param antenas Armazém de antenas.
+ * @param a Índice da primeira antena.
+ * @param b Índice da segunda antena.
+ * @return Distância entre as duas antenas.
+ */
+float calcularDistancia(const ArmazemAntenas* antenas, uint32_t a, uint32_t b) {
+    return distanciaPontos(armazemX(antenas, a), armazemY(antenas, a), armazemX(antenas, b), armazemY(antenas, b));
+}
+#pragma endregion
+
 #pragma region adicionarAresta
+/**
+ * @brief Preenche uma aresta já reservada e coloca-a no início da lista de adjacência da origem.
+ */
+static void encadearAresta(GR* grafo, Aresta* nova, Vertice* origem, Vertice* destino) {
+    nova->distancia = calcularDistancia(grafo->antenas, origem->antena, destino->antena);
+    nova->destino = destino;
+    nova->prox = origem->adj;
+    origem->adj = nova;
+}
+
 /**
  * @brief Adiciona uma aresta entre dois vértices (antenas) no grafo.
+ * @param grafo Grafo a que pertencem os vértices.
  * @param origem Vértice de origem.
  * @param destino Vértice de destino.
  * @return 1 se a aresta foi adicionada com sucesso, 0 caso contrário.
  */
-int adicionarAresta(Vertice* origem, Vertice* destino) {
-    if (!origem || !destino) return 0;
+int adicionarAresta(GR* grafo, Vertice* origem, Vertice* destino) {
+    if (!grafo || !origem || !destino) return 0;
 
-    Aresta* nova = malloc(sizeof(Aresta));
+    Aresta* nova = reservarMemoria(MEM_ARESTAS, sizeof(Aresta));
     if (!nova) return 0;
 
-    nova->distancia = calcularDistancia(&origem->info, &destino->info);
-    nova->destino = destino;
-    nova->prox = origem->adj;
-    origem->adj = nova;
+    encadearAresta(grafo, nova, origem, destino);
+    return 1;
+}
+
+/**
+ * @brief Adiciona as arestas entre dois vértices nos dois sentidos.
+ * @return 1 em caso de sucesso, 0 se faltar memória.
+ */
+static int adicionarPar(GR* grafo, Vertice* a, Vertice* b) {
+    return adicionarAresta(grafo, a, b) && adicionarAresta(grafo, b, a);
+}
+#pragma endregion
+
+#pragma region MapaVertices
+/**
+ * @brief Tabela de dispersão com endereçamento aberto (sondagem linear) de (x,y) para vértice.
+ */
+struct MapaVertices {
+    uint64_t* chaves; //Coordenadas empacotadas de cada posição
+    Vertice** valores; //Vértice de cada posição (NULL se livre)
+    uint32_t capacidade; //Número de posições (potência de 2)
+    uint32_t usados; //Número de posições ocupadas
+};
+
+/**
+ * @brief Empacota umas coordenadas numa chave de 64 bits.
+ */
+static uint64_t chaveCoordenadas(int x, int y) {
+    return ((uint64_t)(uint32_t)x << 32) | (uint32_t)y;
+}
+
+/**
+ * @brief Mistura os bits de uma chave (finalizador do MurmurHash3).
+ */
+static uint32_t dispersar(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return (uint32_t)k;
+}
+
+static void libertarMapa(MapaVertices* mapa);
+
+/**
+ * @brief Cria uma tabela com capacidade para pelo menos n vértices.
+ * @param n Número de vértices esperado.
+ * @return Tabela vazia, ou NULL em caso de erro.
+ */
+static MapaVertices* criarMapa(uint32_t n) {
+    MapaVertices* mapa = reservarMemoria(MEM_VERTICES, sizeof(MapaVertices));
+    if (!mapa) return NULL;
 
+    uint32_t cap = 16;
+    while (cap < 2 * (uint64_t)n) cap *= 2;
+    mapa->chaves = reservarMemoria(MEM_VERTICES, cap * sizeof(uint64_t));
+    mapa->valores = reservarMemoriaZeros(MEM_VERTICES, cap, sizeof(Vertice*));
+    mapa->capacidade = cap;
+    mapa->usados = 0;
+    if (!mapa->chaves || !mapa->valores) {
+        libertarMapa(mapa);
+        return NULL;
+    }
+    return mapa;
+}
+
+/**
+ * @brief Liberta a tabela (os vértices não são libertados).
+ */
+static void libertarMapa(MapaVertices* mapa) {
+    if (!mapa) return;
+    libertarMemoria(MEM_VERTICES, mapa->chaves, mapa->capacidade * sizeof(uint64_t));
+    libertarMemoria(MEM_VERTICES, mapa->valores, mapa->capacidade * sizeof(Vertice*));
+    libertarMemoria(MEM_VERTICES, mapa, sizeof(MapaVertices));
+}
+
+/**
+ * @brief Procura a posição de uma chave na tabela.
+ * @return Posição da chave, ou a posição livre onde deveria ficar.
+ */
+static uint32_t mapaPosicao(const MapaVertices* mapa, uint64_t chave) {
+    uint32_t mascara = mapa->capacidade - 1;
+    uint32_t i = dispersar(chave) & mascara;
+    while (mapa->valores[i] && mapa->chaves[i] != chave) i = (i + 1) & mascara;
+    return i;
+}
+
+/**
+ * @brief Insere (ou substitui) um vértice na tabela, duplicando-a quando fica 70% cheia.
+ * @return 1 em caso de sucesso, 0 caso contrário.
+ */
+static int mapaInserir(MapaVertices* mapa, uint64_t chave, Vertice* v) {
+    if ((uint64_t)(mapa->usados + 1) * 10 > (uint64_t)mapa->capacidade * 7) {
+        uint32_t novaCap = mapa->capacidade * 2;
+        uint64_t* chaves = reservarMemoria(MEM_VERTICES, novaCap * sizeof(uint64_t));
+        Vertice** valores = reservarMemoriaZeros(MEM_VERTICES, novaCap, sizeof(Vertice*));
+        if (!chaves || !valores) {
+            libertarMemoria(MEM_VERTICES, chaves, novaCap * sizeof(uint64_t));
+            libertarMemoria(MEM_VERTICES, valores, novaCap * sizeof(Vertice*));
+            return 0;
+        }
+        for (uint32_t i = 0; i < mapa->capacidade; i++) {
+            if (!mapa->valores[i]) continue;
+            uint32_t j = dispersar(mapa->chaves[i]) & (novaCap - 1);
+            while (valores[j]) j = (j + 1) & (novaCap - 1);
+            chaves[j] = mapa->chaves[i];
+            valores[j] = mapa->valores[i];
+        }
+        libertarMemoria(MEM_VERTICES, mapa->chaves, mapa->capacidade * sizeof(uint64_t));
+        libertarMemoria(MEM_VERTICES, mapa->valores, mapa->capacidade * sizeof(Vertice*));
+        mapa->chaves = chaves;
+        mapa->valores = valores;
+        mapa->capacidade = novaCap;
+    }
+
+    uint32_t i = mapaPosicao(mapa, chave);
+    if (!mapa->valores[i]) mapa->usados++;
+    mapa->chaves[i] = chave;
+    mapa->valores[i] = v;
     return 1;
 }
+
+/**
+ * @brief Remove uma chave da tabela, recuando as chaves seguintes (sem marcas de remoção).
+ */
+static void mapaRemover(MapaVertices* mapa, uint64_t chave) {
+    uint32_t mascara = mapa->capacidade - 1;
+    uint32_t i = mapaPosicao(mapa, chave);
+    if (!mapa->valores[i]) return;
+
+    mapa->valores[i] = NULL;
+    mapa->usados--;
+    for (uint32_t j = (i + 1) & mascara; mapa->valores[j]; j = (j + 1) & mascara) {
+        uint32_t k = dispersar(mapa->chaves[j]) & mascara;
+        // A chave em j só pode recuar para i se a sua posição ideal k não estiver em ]i, j]
+        int ficar = (i <= j) ? (k > i && k <= j) : (k > i || k <= j);
+        if (ficar) continue;
+        mapa->chaves[i] = mapa->chaves[j];
+        mapa->valores[i] = mapa->valores[j];
+        mapa->valores[j] = NULL;
+        i = j;
+    }
+}
 #pragma endregion
 
-#pragma region construirGrafo
+#pragma region registarVertice
 /**
- * @brief Constrói um grafo a partir de uma lista de antenas.
- * @param listaAntenas Lista de antenas.
- * @return Ponteiro para o grafo construído.
+ * @brief Liberta os vetores indexados por antena (porIndice, anteriorIndice, posicaoGrupo e versaoIndice).
+ * @param grafo Ponteiro para o grafo.
  */
-GR* construirGrafo(Antena* listaAntenas) {
-    GR* grafo = malloc(sizeof(GR));
+static void libertarVetoresIndice(GR* grafo) {
+    uint32_t cap = grafo->capIndice;
+    libertarMemoria(MEM_VERTICES, grafo->porIndice, cap * sizeof(Vertice*));
+    libertarMemoria(MEM_VERTICES, grafo->anteriorIndice, cap * sizeof(uint32_t));
+    libertarMemoria(MEM_VERTICES, grafo->posicaoGrupo, cap * sizeof(uint32_t));
+    libertarMemoria(MEM_VERTICES, grafo->versaoIndice, cap * sizeof(uint64_t));
+}
+
+/**
+ * @brief Garante que os vetores indexados por antena cobrem todo o armazém.
+ * @param grafo Ponteiro para o grafo.
+ * @return 1 em caso de sucesso, 0 caso contrário.
+ */
+static int garantirIndice(GR* grafo) {
+    uint32_t total = grafo->antenas->total;
+    if (total <= grafo->capIndice) return 1;
+
+    uint32_t novaCap = grafo->capIndice ? grafo->capIndice : 16;
+    while (novaCap < total) novaCap *= 2;
+    // Os quatro vetores são reservados de novo para que uma falha deixe o grafo intacto
+    Vertice** porIndice = reservarMemoria(MEM_VERTICES, novaCap * sizeof(Vertice*));
+    uint32_t* anteriorIndice = reservarMemoria(MEM_VERTICES, novaCap * sizeof(uint32_t));
+    uint32_t* posicaoGrupo = reservarMemoria(MEM_VERTICES, novaCap * sizeof(uint32_t));
+    uint64_t* versaoIndice = reservarMemoria(MEM_VERTICES, novaCap * sizeof(uint64_t));
+    if (!porIndice || !anteriorIndice || !posicaoGrupo || !versaoIndice) {
+        libertarMemoria(MEM_VERTICES, porIndice, novaCap * sizeof(Vertice*));
+        libertarMemoria(MEM_VERTICES, anteriorIndice, novaCap * sizeof(uint32_t));
+        libertarMemoria(MEM_VERTICES, posicaoGrupo, novaCap * sizeof(uint32_t));
+        libertarMemoria(MEM_VERTICES, versaoIndice, novaCap * sizeof(uint64_t));
+        return 0;
+    }
+
+    uint32_t cap = grafo->capIndice;
+    if (cap) {
+        memcpy(porIndice, grafo->porIndice, cap * sizeof(Vertice*));
+        memcpy(anteriorIndice, grafo->anteriorIndice, cap * sizeof(uint32_t));
+        memcpy(posicaoGrupo, grafo->posicaoGrupo, cap * sizeof(uint32_t));
+        memcpy(versaoIndice, grafo->versaoIndice, cap * sizeof(uint64_t));
+    }
+    for (uint32_t i = cap; i < novaCap; i++) {
+        porIndice[i] = NULL;
+        anteriorIndice[i] = SEM_ANTERIOR;
+        posicaoGrupo[i] = 0;
+        versaoIndice[i] = 0;
+    }
+    libertarVetoresIndice(grafo);
+    grafo->porIndice = porIndice;
+    grafo->anteriorIndice = anteriorIndice;
+    grafo->posicaoGrupo = posicaoGrupo;
+    grafo->versaoIndice = versaoIndice;
+    grafo->capIndice = novaCap;
+    return 1;
+}
+
+/**
+ * @brief Garante espaço para mais um índice no grupo de uma frequência.
+ * @param grafo Ponteiro para o grafo.
+ * @param frequencia Frequência do grupo.
+ * @return 1 em caso de sucesso, 0 caso contrário.
+ */
+static int garantirGrupo(GR* grafo, char frequencia) {
+    GrupoIndices* g = &grafo->grupos[(unsigned char)frequencia];
+    if (g->num < g->capacidade) return 1;
+    uint32_t novaCap = g->capacidade ? g->capacidade * 2 : 16;
+    uint32_t* novo = redimensionarMemoria(MEM_VERTICES, g->indices, g->capacidade * sizeof(uint32_t),
+                                          novaCap * sizeof(uint32_t));
+    if (!novo) return 0;
+    g->indices = novo;
+    g->capacidade = novaCap;
+    return 1;
+}
+
+/**
+ * @brief Acrescenta o índice de um vértice ao grupo da sua frequência.
+ * @return 1 em caso de sucesso, 0 caso contrário.
+ */
+static int entrarNoGrupo(GR* grafo, Vertice* v) {
+    char frequencia = armazemFrequencia(grafo->antenas, v->antena);
+    if (!garantirGrupo(grafo, frequencia)) return 0;
+    GrupoIndices* g = &grafo->grupos[(unsigned char)frequencia];
+    grafo->posicaoGrupo[v->antena] = g->num;
+    g->indices[g->num++] = v->antena;
+    return 1;
+}
+
+/**
+ * @brief Retira o índice de um vértice do grupo da sua frequência (troca com o último).
+ */
+static void sairDoGrupo(GR* grafo, Vertice* v) {
+    GrupoIndices* g = &grafo->grupos[(unsigned char)armazemFrequencia(grafo->antenas, v->antena)];
+    uint32_t ultimo = g->indices[--g->num];
+    if (ultimo == v->antena) return;
+    g->indices[grafo->posicaoGrupo[v->antena]] = ultimo;
+    grafo->posicaoGrupo[ultimo] = grafo->posicaoGrupo[v->antena];
+}
+
+/**
+ * @brief Regista um vértice no índice por antena, no grupo da sua frequência e na tabela de coordenadas.
+ * @param grafo Ponteiro para o grafo.
+ * @param v Vértice a registar.
+ * @return 1 em caso de sucesso, 0 caso contrário (nada fica registado).
+ */
+static int registarVertice(GR* grafo, Vertice* v) {
+    if (!garantirIndice(grafo) || !entrarNoGrupo(grafo, v)) return 0;
+    uint64_t chave = chaveCoordenadas(armazemX(grafo->antenas, v->antena), armazemY(grafo->antenas, v->antena));
+    if (!mapaInserir(grafo->mapa, chave, v)) {
+        sairDoGrupo(grafo, v);
+        return 0;
+    }
+    grafo->porIndice[v->antena] = v;
+    return 1;
+}
+
+/**
+ * @brief Regista que a adjacência de um índice mudou, dando-lhe uma nova versão do grafo.
+ *
+ * Não reserva memória, pelo que não pode falhar: uma vista com versão v tem de reler
+ * as linhas cuja versão é maior do que v.
+ * @param grafo Ponteiro para o grafo.
+ * @param antena Índice da antena cuja adjacência mudou.
+ */
+static void marcarAlterado(GR* grafo, uint32_t antena) {
+    if (antena >= grafo->capIndice) return;
+    grafo->versaoIndice[antena] = ++grafo->versao;
+}
+
+/**
+ * @brief Indica se a linha de um índice mudou depois da versão de uma vista.
+ */
+static int alteradoDesde(const GR* grafo, uint32_t antena, uint64_t versao) {
+    return antena < grafo->capIndice && grafo->versaoIndice[antena] > versao;
+}
+#pragma endregion
+
+#pragma region criarGrafoSemArestas
+/**
+ * @brief Cria um grafo sem vértices com a tabela e o índice dimensionados para o armazém.
+ * @param antenas Armazém de antenas (só passa a pertencer ao grafo em caso de sucesso).
+ * @return Ponteiro para o grafo, ou NULL em caso de erro.
+ */
+static GR* criarGrafoVazio(ArmazemAntenas* antenas) {
+    GR* grafo = reservarMemoriaZeros(MEM_VERTICES, 1, sizeof(GR));
+    if (!grafo) return NULL;
+    grafo->antenas = antenas;
+    grafo->mapa = criarMapa(antenas->total);
+    if (!grafo->mapa || !garantirIndice(grafo)) {
+        grafo->antenas = NULL;
+        libertarGrafo(grafo);
+        return NULL;
+    }
+    return grafo;
+}
+
+/**
+ * @brief Regista um vértice e acrescenta-o ao fim da lista de vértices.
+ * @param grafo Ponteiro para o grafo.
+ * @param ultimo Último vértice da lista (NULL se estiver vazia).
+ * @param novo Vértice a acrescentar.
+ * @return 1 em caso de sucesso, 0 se faltar memória (o vértice não é acrescentado).
+ */
+static int acrescentarVertice(GR* grafo, Vertice* ultimo, Vertice* novo) {
+    if (!registarVertice(grafo, novo)) return 0;
+    novo->proximo = NULL;
+    grafo->anteriorIndice[novo->antena] = ultimo ? ultimo->antena : SEM_ANTERIOR;
+    if (!ultimo) grafo->vertices = novo;
+    else ultimo->proximo = novo;
+    grafo->numVertices++;
+    return 1;
+}
+
+/**
+ * @brief Cria um grafo com um vértice por antena do armazém e sem arestas.
+ * @param antenas Armazém de antenas (passa a pertencer ao grafo em caso de sucesso).
+ * @return Ponteiro para o grafo, ou NULL em caso de erro.
+ */
+GR* criarGrafoSemArestas(ArmazemAntenas* antenas) {
+    if (!antenas) return NULL;
+    GR* grafo = criarGrafoVazio(antenas);
     if (!grafo) return NULL;
-    grafo->vertices = NULL;
-    grafo->numVertices = 0;
 
     Vertice* ultimo = NULL;
-    for (Antena* a = listaAntenas; a != NULL; a = a->prox) {
-        Vertice* novo = inserirVertice(NULL, *a);
-        grafo->numVertices++;
+    for (uint32_t i = 0; i < antenas->total; i++) {
+        if (armazemFrequencia(antenas, i) == 0) continue;
+        Vertice* novo = inserirVertice(NULL, i);
+        if (!novo || !acrescentarVertice(grafo, ultimo, novo)) {
+            libertarMemoria(MEM_VERTICES, novo, sizeof(Vertice));
+            grafo->antenas = NULL;
+            libertarGrafo(grafo);
+            return NULL;
+        }
+        ultimo = novo;
+    }
+
+    return grafo;
+}
 
-        if (!grafo->vertices) {
-            grafo->vertices = novo;
-            ultimo = novo;
-        } else {
-            ultimo->proximo = novo;
-            ultimo = novo;
+/**
+ * @brief Cria um grafo a partir de vértices já construídos (com as respetivas arestas).
+ * @param antenas Armazém de antenas.
+ * @param vertices Vértice de cada índice do armazém (NULL se não existir).
+ * @return Ponteiro para o grafo, ou NULL em caso de erro. Em caso de sucesso, o armazém e os
+ *         vértices passam a pertencer ao grafo; em caso de erro continuam a pertencer a quem chama.
+ */
+GR* criarGrafoComVertices(ArmazemAntenas* antenas, Vertice** vertices) {
+    if (!antenas || !vertices) return NULL;
+    GR* grafo = criarGrafoVazio(antenas);
+    if (!grafo) return NULL;
+
+    Vertice* ultimo = NULL;
+    for (uint32_t i = 0; i < antenas->total; i++) {
+        if (!vertices[i]) continue;
+        if (!acrescentarVertice(grafo, ultimo, vertices[i])) {
+            // Os vértices continuam a pertencer a quem chama
+            grafo->vertices = NULL;
+            grafo->antenas = NULL;
+            libertarGrafo(grafo);
+            return NULL;
         }
+        ultimo = vertices[i];
+    }
+
+    return grafo;
+}
+#pragma endregion
+
+#pragma region construirGrafo
+/**
+ * @brief Constrói um grafo a partir de uma lista de antenas.
+ * @param listaAntenas Lista de antenas.
+ * @return Ponteiro para o grafo construído, ou NULL em caso de erro.
+ */
+GR* construirGrafo(Antena* listaAntenas) {
+    ArmazemAntenas* antenas = criarArmazem(listaAntenas);
+    if (!antenas) return NULL;
+    GR* grafo = criarGrafoSemArestas(antenas);
+    if (!grafo) {
+        libertarArmazem(antenas);
+        return NULL;
     }
 
     for (Vertice* v1 = grafo->vertices; v1 != NULL; v1 = v1->proximo) {
         for (Vertice* v2 = v1->proximo; v2 != NULL; v2 = v2->proximo) {
-            if (v1->info.frequencia == v2->info.frequencia) {
-                adicionarAresta(v1, v2);
-                adicionarAresta(v2, v1);
+            if (armazemFrequencia(grafo->antenas, v1->antena) == armazemFrequencia(grafo->antenas, v2->antena) &&
+                !adicionarPar(grafo, v1, v2)) {
+                libertarGrafo(grafo);
+                return NULL;
+            }
+        }
+    }
+
+    return grafo;
+}
+#pragma endregion
+
+#pragma region MelhoresVizinhos
+/**
+ * @brief Lista ordenada (por distância) das k melhores antenas candidatas.
+ */
+typedef struct MelhoresVizinhos {
+    uint32_t* indices; //Índices de antena, do mais próximo para o mais afastado
+    float* distancias; //Distância de cada candidato
+    int num; //Número de candidatos guardados
+    int k; //Número máximo de candidatos
+} MelhoresVizinhos;
+
+/**
+ * @brief Insere um candidato, mantendo apenas os k mais próximos.
+ * @param m Lista de candidatos.
+ * @param j Índice da antena candidata.
+ * @param d Distância da candidata.
+ */
+static void melhoresInserir(MelhoresVizinhos* m, uint32_t j, float d) {
+    if (m->num == m->k && d >= m->distancias[m->k - 1]) return;
+
+    int pos = m->num < m->k ? m->num++ : m->k - 1;
+    while (pos > 0 && m->distancias[pos - 1] > d) {
+        m->distancias[pos] = m->distancias[pos - 1];
+        m->indices[pos] = m->indices[pos - 1];
+        pos--;
+    }
+    m->distancias[pos] = d;
+    m->indices[pos] = j;
+}
+#pragma endregion
+
+#pragma region construirGrafoRaio
+/**
+ * @brief Constrói um grafo que só liga antenas da mesma frequência até uma distância máxima.
+ *
+ * Para cada frequência é criada uma grelha com células de lado igual ao raio; cada antena
+ * só é comparada com as antenas das 9 células à sua volta.
+ * @param listaAntenas Lista ligada de antenas.
+ * @param raio Distância máxima entre antenas ligadas.
+ * @return Ponteiro para o grafo construído, ou NULL em caso de erro.
+ */
+GR* construirGrafoRaio(Antena* listaAntenas, float raio) {
+    if (raio < 0) return NULL;
+    ArmazemAntenas* antenas = criarArmazem(listaAntenas);
+    if (!antenas) return NULL;
+    GR* grafo = criarGrafoSemArestas(antenas);
+    if (!grafo) {
+        libertarArmazem(antenas);
+        return NULL;
+    }
+    grafo->modo = LIGACAO_RAIO;
+    grafo->raio = raio;
+
+    uint32_t inicio[257];
+    uint32_t* grupos = armazemAgruparPorFrequencia(antenas, inicio);
+    int ok = grupos != NULL;
+
+    for (int f = 1; f < 256 && ok; f++) {
+        uint32_t m = inicio[f + 1] - inicio[f];
+        if (m < 2) continue;
+        GrelhaEspacial* grelha = criarGrelha(antenas, &grupos[inicio[f]], m, raio > 1 ? raio : 1);
+        if (!grelha) {
+            ok = 0;
+            break;
+        }
+
+        for (uint32_t p = inicio[f]; p < inicio[f + 1] && ok; p++) {
+            uint32_t i = grupos[p];
+            int64_t cx = grelhaCelula(grelha, armazemX(antenas, i));
+            int64_t cy = grelhaCelula(grelha, armazemY(antenas, i));
+
+            for (int64_t dy = -1; dy <= 1 && ok; dy++) {
+                for (int64_t dx = -1; dx <= 1 && ok; dx++) {
+                    const uint32_t* itens;
+                    uint32_t n = grelhaBalde(grelha, cx + dx, cy + dy, &itens);
+                    for (uint32_t t = 0; t < n && ok; t++) {
+                        uint32_t j = itens[t];
+                        // Cada par é ligado uma só vez, a partir do menor índice
+                        if (j <= i) continue;
+                        if (grelhaCelula(grelha, armazemX(antenas, j)) != cx + dx ||
+                            grelhaCelula(grelha, armazemY(antenas, j)) != cy + dy) continue;
+                        if (calcularDistancia(antenas, i, j) > raio) continue;
+                        ok = adicionarPar(grafo, grafo->porIndice[i], grafo->porIndice[j]);
+                    }
+                }
+            }
+        }
+        libertarGrelha(grelha);
+    }
+
+    libertarGruposFrequencia(grupos, inicio);
+    if (!ok) {
+        libertarGrafo(grafo);
+        return NULL;
+    }
+    return grafo;
+}
+#pragma endregion
+
+#pragma region construirGrafoKProximos
+/**
+ * @brief Visita as antenas de uma célula da grelha como candidatas a vizinhas de i.
+ */
+static void visitarCelula(const GrelhaEspacial* grelha, int64_t cx, int64_t cy, uint32_t i, MelhoresVizinhos* m) {
+    const uint32_t* itens;
+    uint32_t n = grelhaBalde(grelha, cx, cy, &itens);
+    for (uint32_t t = 0; t < n; t++) {
+        uint32_t j = itens[t];
+        if (j == i) continue;
+        if (grelhaCelula(grelha, armazemX(grelha->antenas, j)) != cx ||
+            grelhaCelula(grelha, armazemY(grelha->antenas, j)) != cy) continue;
+        melhoresInserir(m, j, calcularDistancia(grelha->antenas, i, j));
+    }
+}
+
+/**
+ * @brief Procura as k antenas mais próximas de i em anéis de células cada vez maiores.
+ *
+ * Depois de visitar os anéis 0 a r, todas as antenas a uma distância até r * tamanho já foram
+ * vistas, pelo que a procura termina quando a k-ésima candidata está dentro desse raio.
+ * @param grelha Grelha do grupo de frequência de i.
+ * @param i Índice da antena.
+ * @param maxAnel Último anel que ainda pode conter antenas do grupo.
+ * @param m Lista de candidatos (vazia à entrada).
+ */
+static void procurarKProximos(const GrelhaEspacial* grelha, uint32_t i, int64_t maxAnel, MelhoresVizinhos* m) {
+    int64_t cx = grelhaCelula(grelha, armazemX(grelha->antenas, i));
+    int64_t cy = grelhaCelula(grelha, armazemY(grelha->antenas, i));
+
+    visitarCelula(grelha, cx, cy, i, m);
+    for (int64_t r = 1; r <= maxAnel; r++) {
+        if (m->num == m->k && m->distancias[m->k - 1] <= (r - 1) * grelha->tamanho) break;
+        for (int64_t d = -r; d <= r; d++) {
+            visitarCelula(grelha, cx + d, cy - r, i, m);
+            visitarCelula(grelha, cx + d, cy + r, i, m);
+        }
+        for (int64_t d = -r + 1; d <= r - 1; d++) {
+            visitarCelula(grelha, cx - r, cy + d, i, m);
+            visitarCelula(grelha, cx + r, cy + d, i, m);
+        }
+    }
+}
+
+/**
+ * @brief Constrói um grafo que liga cada antena às k antenas mais próximas da mesma frequência.
+ *
+ * O lado das células é escolhido para que cada célula tenha, em média, cerca de k antenas
+ * do grupo. As listas de vizinhos são calculadas primeiro e depois ligadas sem repetir pares.
+ * @param listaAntenas Lista ligada de antenas.
+ * @param k Número de vizinhos por antena.
+ * @return Ponteiro para o grafo construído, ou NULL em caso de erro.
+ */
+GR* construirGrafoKProximos(Antena* listaAntenas, int k) {
+    if (k < 0) return NULL;
+    ArmazemAntenas* antenas = criarArmazem(listaAntenas);
+    if (!antenas) return NULL;
+    GR* grafo = criarGrafoSemArestas(antenas);
+    if (!grafo) {
+        libertarArmazem(antenas);
+        return NULL;
+    }
+    grafo->modo = LIGACAO_K_PROXIMOS;
+    grafo->k = k;
+    if (k == 0) return grafo;
+
+    uint32_t inicio[257];
+    uint32_t* grupos = armazemAgruparPorFrequencia(antenas, inicio);
+    size_t tamVizinhos = (size_t)(inicio[256] ? inicio[256] : 1) * k * sizeof(uint32_t);
+    uint32_t* vizinhos = reservarMemoria(MEM_OUTROS, tamVizinhos);
+    float* distancias = reservarMemoria(MEM_OUTROS, (size_t)k * sizeof(float));
+    int ok = grupos && vizinhos && distancias;
+
+    for (int f = 1; f < 256 && ok; f++) {
+        uint32_t m = inicio[f + 1] - inicio[f];
+        if (m < 2) continue;
+        int kk = (uint32_t)k < m ? k : (int)(m - 1);
+
+        // Caixa envolvente do grupo para escolher o lado das células
+        int minX = armazemX(antenas, grupos[inicio[f]]), maxX = minX;
+        int minY = armazemY(antenas, grupos[inicio[f]]), maxY = minY;
+        for (uint32_t p = inicio[f]; p < inicio[f + 1]; p++) {
+            int x = armazemX(antenas, grupos[p]), y = armazemY(antenas, grupos[p]);
+            if (x < minX) minX = x;
+            if (x > maxX) maxX = x;
+            if (y < minY) minY = y;
+            if (y > maxY) maxY = y;
+        }
+        double largura = (double)maxX - minX + 1, altura = (double)maxY - minY + 1;
+        float tamanho = (float)sqrt(largura * altura * kk / m);
+        if (tamanho < 1) tamanho = 1;
+        int64_t maxAnel = (int64_t)ceil((largura > altura ? largura : altura) / tamanho) + 1;
+
+        GrelhaEspacial* grelha = criarGrelha(antenas, &grupos[inicio[f]], m, tamanho);
+        if (!grelha) {
+            ok = 0;
+            break;
+        }
+
+        for (uint32_t p = inicio[f]; p < inicio[f + 1]; p++) {
+            MelhoresVizinhos melhores = { &vizinhos[(size_t)p * k], distancias, 0, kk };
+            procurarKProximos(grelha, grupos[p], maxAnel, &melhores);
+        }
+        libertarGrelha(grelha);
+
+        // Ligar cada par uma vez: a partir de i se i < j ou se i não for vizinha de j
+        for (uint32_t p = inicio[f]; p < inicio[f + 1] && ok; p++) {
+            uint32_t i = grupos[p];
+            for (int n = 0; n < kk && ok; n++) {
+                uint32_t j = vizinhos[(size_t)p * k + n];
+                int reciproco = 0;
+                if (j < i) {
+                    // Os índices do grupo estão por ordem crescente: posição de j por pesquisa binária
+                    uint32_t lo = inicio[f], hi = inicio[f + 1];
+                    while (lo < hi) {
+                        uint32_t meio = lo + (hi - lo) / 2;
+                        if (grupos[meio] < j) lo = meio + 1;
+                        else hi = meio;
+                    }
+                    for (int t = 0; t < kk && !reciproco; t++) {
+                        reciproco = vizinhos[(size_t)lo * k + t] == i;
+                    }
+                }
+                if (reciproco) continue;
+                ok = adicionarPar(grafo, grafo->porIndice[i], grafo->porIndice[j]);
             }
         }
     }
 
+    libertarMemoria(MEM_OUTROS, distancias, (size_t)k * sizeof(float));
+    libertarMemoria(MEM_OUTROS, vizinhos, tamVizinhos);
+    libertarGruposFrequencia(grupos, inicio);
+    if (!ok) {
+        libertarGrafo(grafo);
+        return NULL;
+    }
     return grafo;
 }
 #pragma endregion
 
+#pragma region procurarVertice
+/**
+ * @brief Procura o vértice de uma antena na tabela de coordenadas, em tempo O(1).
+ * @param grafo Ponteiro para o grafo.
+ * @param x Coordenada X da antena.
+ * @param y Coordenada Y da antena.
+ * @return Vértice da antena, ou NULL se não existir.
+ */
+Vertice* procurarVertice(GR* grafo, int x, int y) {
+    if (!grafo || !grafo->mapa) return NULL;
+    return grafo->mapa->valores[mapaPosicao(grafo->mapa, chaveCoordenadas(x, y))];
+}
+#pragma endregion
+
+#pragma region ligarAoGrupo
+/**
+ * @brief Ligações de um vértice ao seu grupo, calculadas e reservadas antes de serem feitas.
+ */
+typedef struct LigacoesPendentes {
+    uint32_t* vizinhos; //Índices de antena a ligar
+    size_t tamVizinhos; //Bytes reservados para vizinhos
+    uint32_t num; //Número de vizinhos
+    Aresta* reserva; //Arestas já reservadas (duas por vizinho), encadeadas por prox
+} LigacoesPendentes;
+
+/**
+ * @brief Liberta as ligações pendentes que não chegaram a ser feitas.
+ */
+static void libertarLigacoes(LigacoesPendentes* l) {
+    while (l->reserva) {
+        Aresta* temp = l->reserva;
+        l->reserva = temp->prox;
+        libertarMemoria(MEM_ARESTAS, temp, sizeof(Aresta));
+    }
+    libertarMemoria(MEM_OUTROS, l->vizinhos, l->tamVizinhos);
+    l->vizinhos = NULL;
+    l->num = 0;
+}
+
+/**
+ * @brief Calcula os vizinhos de uma antena no grupo de uma frequência, segundo o modo de ligação
+ *        do grafo, e reserva já todas as arestas necessárias.
+ *
+ * Os vizinhos são encontrados no grupo de índices da frequência, em tempo O(tamanho do grupo).
+ * O grafo não é alterado, pelo que uma falha não deixa ligações a meio.
+ * @param grafo Ponteiro para o grafo.
+ * @param antena Índice da antena (que não está no grupo).
+ * @param frequencia Frequência do grupo.
+ * @param l Estrutura onde são devolvidas as ligações.
+ * @return 1 em caso de sucesso, 0 se faltar memória (nada fica reservado).
+ */
+static int prepararLigacoes(GR* grafo, uint32_t antena, char frequencia, LigacoesPendentes* l) {
+    l->vizinhos = NULL;
+    l->tamVizinhos = 0;
+    l->num = 0;
+    l->reserva = NULL;
+    const GrupoIndices* grupo = &grafo->grupos[(unsigned char)frequencia];
+
+    if (grafo->modo == LIGACAO_K_PROXIMOS) {
+        if (grafo->k <= 0) return 1;
+        MelhoresVizinhos melhores = {0};
+        melhores.k = grafo->k;
+        melhores.indices = reservarMemoria(MEM_OUTROS, (size_t)grafo->k * sizeof(uint32_t));
+        melhores.distancias = reservarMemoria(MEM_OUTROS, (size_t)grafo->k * sizeof(float));
+        if (!melhores.indices || !melhores.distancias) {
+            libertarMemoria(MEM_OUTROS, melhores.indices, (size_t)grafo->k * sizeof(uint32_t));
+            libertarMemoria(MEM_OUTROS, melhores.distancias, (size_t)grafo->k * sizeof(float));
+            return 0;
+        }
+        for (uint32_t n = 0; n < grupo->num; n++) {
+            uint32_t i = grupo->indices[n];
+            if (i != antena) melhoresInserir(&melhores, i, calcularDistancia(grafo->antenas, antena, i));
+        }
+        libertarMemoria(MEM_OUTROS, melhores.distancias, (size_t)grafo->k * sizeof(float));
+        l->vizinhos = melhores.indices;
+        l->tamVizinhos = (size_t)grafo->k * sizeof(uint32_t);
+        l->num = (uint32_t)melhores.num;
+    } else {
+        l->tamVizinhos = (size_t)(grupo->num ? grupo->num : 1) * sizeof(uint32_t);
+        l->vizinhos = reservarMemoria(MEM_OUTROS, l->tamVizinhos);
+        if (!l->vizinhos) return 0;
+        for (uint32_t n = 0; n < grupo->num; n++) {
+            uint32_t i = grupo->indices[n];
+            if (i == antena) continue;
+            if (grafo->modo == LIGACAO_RAIO && calcularDistancia(grafo->antenas, antena, i) > grafo->raio) continue;
+            l->vizinhos[l->num++] = i;
+        }
+    }
+
+    for (uint64_t n = 0; n < 2 * (uint64_t)l->num; n++) {
+        Aresta* a = reservarMemoria(MEM_ARESTAS, sizeof(Aresta));
+        if (!a) {
+            libertarLigacoes(l);
+            return 0;
+        }
+        a->prox = l->reserva;
+        l->reserva = a;
+    }
+    return 1;
+}
+
+/**
+ * @brief Faz as ligações preparadas por prepararLigacoes (não pode falhar).
+ * @param grafo Ponteiro para o grafo.
+ * @param v Vértice a ligar (já registado no grupo).
+ * @param l Ligações pendentes (ficam vazias).
+ */
+static void ligarAoGrupo(GR* grafo, Vertice* v, LigacoesPendentes* l) {
+    marcarAlterado(grafo, v->antena);
+    for (uint32_t n = 0; n < l->num; n++) {
+        Vertice* outro = grafo->porIndice[l->vizinhos[n]];
+        Aresta* a = l->reserva;
+        Aresta* b = a->prox;
+        l->reserva = b->prox;
+        encadearAresta(grafo, a, v, outro);
+        encadearAresta(grafo, b, outro, v);
+        marcarAlterado(grafo, l->vizinhos[n]);
+    }
+    libertarLigacoes(l);
+}
+#pragma endregion
+
+#pragma region desligarVertice
+/**
+ * @brief Remove a primeira aresta de origem para destino.
+ * @return 1 se a aresta foi removida, 0 caso contrário.
+ */
+static int removerAresta(Vertice* origem, Vertice* destino) {
+    for (Aresta** a = &origem->adj; *a; a = &(*a)->prox) {
+        if ((*a)->destino == destino) {
+            Aresta* temp = *a;
+            *a = temp->prox;
+            libertarMemoria(MEM_ARESTAS, temp, sizeof(Aresta));
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Remove todas as arestas de um vértice, nos dois sentidos.
+ * @param grafo Ponteiro para o grafo.
+ * @param v Vértice a desligar.
+ */
+static void desligarVertice(GR* grafo, Vertice* v) {
+    marcarAlterado(grafo, v->antena);
+    Aresta* a = v->adj;
+    while (a) {
+        removerAresta(a->destino, v);
+        marcarAlterado(grafo, a->destino->antena);
+        Aresta* temp = a;
+        a = a->prox;
+        libertarMemoria(MEM_ARESTAS, temp, sizeof(Aresta));
+    }
+    v->adj = NULL;
+}
+#pragma endregion
+
+#pragma region grafoAdicionarAntena
+/**
+ * @brief Acrescenta uma antena ao grafo sem o reconstruir.
+ *
+ * A antena é acrescentada ao armazém, o vértice é inserido no início da lista
+ * e só são criadas as arestas do seu grupo de frequência.
+ * @param grafo Ponteiro para o grafo.
+ * @param frequencia Frequência da nova antena.
+ * @param x Coordenada X.
+ * @param y Coordenada Y.
+ * @return Novo vértice, ou NULL se a posição estiver ocupada ou houver erro (o grafo não muda).
+ */
+Vertice* grafoAdicionarAntena(GR* grafo, char frequencia, int x, int y) {
+    if (!grafo || frequencia == 0 || procurarVertice(grafo, x, y)) return NULL;
+
+    uint32_t indice;
+    if (!armazemAdicionar(grafo->antenas, frequencia, x, y, &indice)) return NULL;
+
+    LigacoesPendentes ligacoes;
+    if (!prepararLigacoes(grafo, indice, frequencia, &ligacoes)) {
+        armazemDefinirFrequencia(grafo->antenas, indice, 0);
+        return NULL;
+    }
+
+    Vertice* novo = inserirVertice(grafo->vertices, indice);
+    if (!novo || novo == grafo->vertices || !registarVertice(grafo, novo)) {
+        if (novo && novo != grafo->vertices) libertarMemoria(MEM_VERTICES, novo, sizeof(Vertice));
+        libertarLigacoes(&ligacoes);
+        armazemDefinirFrequencia(grafo->antenas, indice, 0);
+        return NULL;
+    }
+    grafo->anteriorIndice[indice] = SEM_ANTERIOR;
+    if (novo->proximo) grafo->anteriorIndice[novo->proximo->antena] = indice;
+    grafo->vertices = novo;
+    grafo->numVertices++;
+
+    ligarAoGrupo(grafo, novo, &ligacoes);
+    return novo;
+}
+#pragma endregion
+
+#pragma region grafoRemoverAntena
+/**
+ * @brief Remove uma antena do grafo sem o reconstruir.
+ *
+ * O índice da antena fica livre no armazém, pelo que os índices das outras antenas não mudam.
+ * @param grafo Ponteiro para o grafo.
+ * @param x Coordenada X.
+ * @param y Coordenada Y.
+ * @return 1 se a antena foi removida, 0 caso contrário.
+ */
+int grafoRemoverAntena(GR* grafo, int x, int y) {
+    Vertice* v = procurarVertice(grafo, x, y);
+    if (!v) return 0;
+
+    desligarVertice(grafo, v);
+
+    uint32_t anterior = grafo->anteriorIndice[v->antena];
+    if (anterior != SEM_ANTERIOR) grafo->porIndice[anterior]->proximo = v->proximo;
+    else grafo->vertices = v->proximo;
+    if (v->proximo) grafo->anteriorIndice[v->proximo->antena] = anterior;
+
+    mapaRemover(grafo->mapa, chaveCoordenadas(x, y));
+    sairDoGrupo(grafo, v);
+    grafo->porIndice[v->antena] = NULL;
+    armazemDefinirFrequencia(grafo->antenas, v->antena, 0);
+    grafo->numVertices--;
+    libertarMemoria(MEM_VERTICES, v, sizeof(Vertice));
+    return 1;
+}
+#pragma endregion
+
+#pragma region grafoAlterarFrequencia
+/**
+ * @brief Muda uma antena de grupo de frequência sem reconstruir o grafo.
+ * @param grafo Ponteiro para o grafo.
+ * @param x Coordenada X.
+ * @param y Coordenada Y.
+ * @param frequencia Nova frequência.
+ * @return 1 se a frequência foi alterada, 0 caso contrário (em caso de erro o grafo não muda).
+ */
+int grafoAlterarFrequencia(GR* grafo, int x, int y, char frequencia) {
+    Vertice* v = procurarVertice(grafo, x, y);
+    if (!v || frequencia == 0) return 0;
+    if (armazemFrequencia(grafo->antenas, v->antena) == frequencia) return 1;
+    LigacoesPendentes ligacoes;
+    if (!garantirGrupo(grafo, frequencia) || !prepararLigacoes(grafo, v->antena, frequencia, &ligacoes)) return 0;
+
+    desligarVertice(grafo, v);
+    sairDoGrupo(grafo, v);
+    armazemDefinirFrequencia(grafo->antenas, v->antena, frequencia);
+    entrarNoGrupo(grafo, v); // Não falha: o espaço já foi garantido
+    ligarAoGrupo(grafo, v, &ligacoes);
+    return 1;
+}
+#pragma endregion
+
+#pragma region construirCSR
+/**
+ * @brief Liberta os vetores de uma vista CSR (os tamanhos são deduzidos dos contadores).
+ */
+static void libertarArraysCSR(GrafoCSR* csr) {
+    size_t tamArestas = csr->numArestas ? csr->numArestas : 1;
+    libertarMemoria(MEM_ARESTAS, csr->inicio, ((size_t)csr->numVertices + 1) * sizeof(uint32_t));
+    libertarMemoria(MEM_ARESTAS, csr->destinos, tamArestas * sizeof(uint32_t));
+    libertarMemoria(MEM_ARESTAS, csr->distancias, tamArestas * sizeof(float));
+}
+
+/**
+ * @brief Preenche a linha CSR de um vértice a partir da sua lista de adjacência.
+ */
+static uint32_t copiarLinha(const Vertice* v, uint32_t* destinos, float* distancias) {
+    uint32_t n = 0;
+    for (Aresta* a = v ? v->adj : NULL; a != NULL; a = a->prox, n++) {
+        destinos[n] = a->destino->antena;
+        distancias[n] = a->distancia;
+    }
+    return n;
+}
+
+/**
+ * @brief Conta as arestas de um vértice.
+ */
+static uint32_t grauVertice(const Vertice* v) {
+    uint32_t n = 0;
+    for (Aresta* a = v ? v->adj : NULL; a != NULL; a = a->prox) n++;
+    return n;
+}
+
+/**
+ * @brief Constrói a vista CSR do grafo, que fica com a versão atual do grafo.
+ * @param grafo Ponteiro para o grafo.
+ * @return Vista CSR, ou NULL em caso de erro.
+ */
+GrafoCSR* construirCSR(GR* grafo) {
+    if (!grafo) return NULL;
+    GrafoCSR* csr = reservarMemoriaZeros(MEM_ARESTAS, 1, sizeof(GrafoCSR));
+    if (!csr) return NULL;
+
+    uint32_t n = grafo->antenas->total;
+    csr->numVertices = n;
+    csr->inicio = reservarMemoria(MEM_ARESTAS, (n + 1) * sizeof(uint32_t));
+    if (!csr->inicio) {
+        libertarCSR(csr);
+        return NULL;
+    }
+    csr->inicio[0] = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        csr->inicio[i + 1] = csr->inicio[i] + grauVertice(grafo->porIndice[i]);
+    }
+    csr->numArestas = csr->inicio[n];
+    csr->destinos = reservarMemoria(MEM_ARESTAS, (csr->numArestas ? csr->numArestas : 1) * sizeof(uint32_t));
+    csr->distancias = reservarMemoria(MEM_ARESTAS, (csr->numArestas ? csr->numArestas : 1) * sizeof(float));
+    if (!csr->destinos || !csr->distancias) {
+        libertarCSR(csr);
+        return NULL;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        copiarLinha(grafo->porIndice[i], &csr->destinos[csr->inicio[i]], &csr->distancias[csr->inicio[i]]);
+    }
+
+    csr->versao = grafo->versao;
+    return csr;
+}
+#pragma endregion
+
+#pragma region aplicarDeltasCSR
+/**
+ * @brief Atualiza a vista CSR com as alterações feitas no grafo desde a versão da vista.
+ *
+ * Os graus novos são calculados numa passagem; as linhas sem alterações são copiadas em
+ * bloco da vista anterior e só as linhas alteradas são lidas das listas de adjacência.
+ * @param csr Vista CSR a atualizar.
+ * @param grafo Ponteiro para o grafo.
+ * @return 1 se a vista foi atualizada, 0 caso contrário.
+ */
+int aplicarDeltasCSR(GrafoCSR* csr, GR* grafo) {
+    if (!csr || !grafo) return 0;
+    if (csr->versao == grafo->versao && csr->numVertices == grafo->antenas->total) return 1;
+
+    uint32_t n = grafo->antenas->total;
+    uint32_t* inicio = reservarMemoria(MEM_ARESTAS, (n + 1) * sizeof(uint32_t));
+    if (!inicio) return 0;
+
+    inicio[0] = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t grau;
+        if (alteradoDesde(grafo, i, csr->versao)) grau = grauVertice(grafo->porIndice[i]);
+        else if (i < csr->numVertices) grau = csr->inicio[i + 1] - csr->inicio[i];
+        else grau = 0;
+        inicio[i + 1] = inicio[i] + grau;
+    }
+
+    uint32_t m = inicio[n];
+    size_t tamArestas = m ? m : 1;
+    uint32_t* destinos = reservarMemoria(MEM_ARESTAS, tamArestas * sizeof(uint32_t));
+    float* distancias = reservarMemoria(MEM_ARESTAS, tamArestas * sizeof(float));
+    if (!destinos || !distancias) {
+        libertarMemoria(MEM_ARESTAS, inicio, (n + 1) * sizeof(uint32_t));
+        libertarMemoria(MEM_ARESTAS, destinos, tamArestas * sizeof(uint32_t));
+        libertarMemoria(MEM_ARESTAS, distancias, tamArestas * sizeof(float));
+        return 0;
+    }
+
+    uint32_t i = 0;
+    while (i < n) {
+        if (alteradoDesde(grafo, i, csr->versao)) {
+            copiarLinha(grafo->porIndice[i], &destinos[inicio[i]], &distancias[inicio[i]]);
+            i++;
+            continue;
+        }
+        // Bloco de linhas sem alterações: uma única cópia
+        uint32_t fim = i;
+        while (fim < n && fim < csr->numVertices && !alteradoDesde(grafo, fim, csr->versao)) fim++;
+        if (fim == i) { // Índice novo sem arestas
+            i++;
+            continue;
+        }
+        uint32_t qtd = csr->inicio[fim] - csr->inicio[i];
+        memcpy(&destinos[inicio[i]], &csr->destinos[csr->inicio[i]], qtd * sizeof(uint32_t));
+        memcpy(&distancias[inicio[i]], &csr->distancias[csr->inicio[i]], qtd * sizeof(float));
+        i = fim;
+    }
+
+    libertarArraysCSR(csr);
+    csr->inicio = inicio;
+    csr->destinos = destinos;
+    csr->distancias = distancias;
+    csr->numVertices = n;
+    csr->numArestas = m;
+    csr->versao = grafo->versao;
+    return 1;
+}
+#pragma endregion
+
+#pragma region libertarCSR
+/**
+ * @brief Liberta a memória de uma vista CSR.
+ * @param csr Vista CSR.
+ */
+void libertarCSR(GrafoCSR* csr) {
+    if (!csr) return;
+    libertarArraysCSR(csr);
+    libertarMemoria(MEM_ARESTAS, csr, sizeof(GrafoCSR));
+}
+#pragma endregion
+
 #pragma region mostrarGrafo
 /**
  * @brief Mostra o grafo no formato de lista de adjacências.
@@ -101,15 +1144,16 @@ GR* construirGrafo(Antena* listaAntenas) {
  */
 int mostrarGrafo(GR* grafo) {
     if (!grafo || !grafo->vertices) return 0;
+    const ArmazemAntenas* ant = grafo->antenas;
     Vertice* g = grafo->vertices;
     while (g) {
-        printf("%c (%d,%d): ", g->info.frequencia, g->info.x, g->info.y);
+        printf("%c (%d,%d): ", armazemFrequencia(ant, g->antena), armazemX(ant, g->antena), armazemY(ant, g->antena));
         Aresta* a = g->adj;
         while (a) {
             printf("-> %c(%d,%d) ",
-                   a->destino->info.frequencia,
-                   a->destino->info.x,
-                   a->destino->info.y);
+                   armazemFrequencia(ant, a->destino->antena),
+                   armazemX(ant, a->destino->antena),
+                   armazemY(ant, a->destino->antena));
             a = a->prox;
         }
         printf("\n");
@@ -145,13 +1189,19 @@ int libertarGrafo(GR* grafo) {
         while (a) {
             Aresta* temp = a;
             a = a->prox;
-            free(temp);
+            libertarMemoria(MEM_ARESTAS, temp, sizeof(Aresta));
         }
         Vertice* tempV = g;
         g = g->proximo;
-        free(tempV);
+        libertarMemoria(MEM_VERTICES, tempV, sizeof(Vertice));
+    }
+    libertarMapa(grafo->mapa);
+    libertarVetoresIndice(grafo);
+    for (int f = 0; f < 256; f++) {
+        libertarMemoria(MEM_VERTICES, grafo->grupos[f].indices, grafo->grupos[f].capacidade * sizeof(uint32_t));
     }
-    free(grafo);
+    libertarArmazem(grafo->antenas);
+    libertarMemoria(MEM_VERTICES, grafo, sizeof(GR));
     return 1;
 }
 #pragma endregion
@@ -172,7 +1222,8 @@ void bfs(GR* grafo, Vertice* origem) {
 
     while (inicio < fim) {
         Vertice* atual = fila[inicio++];
-        printf("Visitado: %c (%d,%d)\n", atual->info.frequencia, atual->info.x, atual->info.y);
+        printf("Visitado: %c (%d,%d)\n", armazemFrequencia(grafo->antenas, atual->antena),
+               armazemX(grafo->antenas, atual->antena), armazemY(grafo->antenas, atual->antena));
 
         for (Aresta* adj = atual->adj; adj != NULL; adj = adj->prox) {
             if (!adj->destino->visitado) {
@@ -193,7 +1244,8 @@ void dfs(GR* grafo, Vertice* origem) {
     if (!origem || origem->visitado) return;
 
     origem->visitado = 1;
-    printf("Visitado: %c (%d,%d)\n", origem->info.frequencia, origem->info.x, origem->info.y);
+    printf("Visitado: %c (%d,%d)\n", armazemFrequencia(grafo->antenas, origem->antena),
+           armazemX(grafo->antenas, origem->antena), armazemY(grafo->antenas, origem->antena));
 
     for (Aresta* adj = origem->adj; adj != NULL; adj = adj->prox) {
         if (!adj->destino->visitado)
@@ -220,6 +1272,21 @@ int guardarGrafoBinario(const char* nomeFicheiro, Vertice* grafo) {
     return 1;
 }*/
 
+/**
+ * @brief Escreve uma antena no ficheiro binário (frequência, X e Y, sem padding).
+ * @param f Ficheiro aberto para escrita.
+ * @param antenas Armazém de antenas.
+ * @param i Índice da antena.
+ */
+static void escreverAntena(FILE* f, const ArmazemAntenas* antenas, uint32_t i) {
+    char frequencia = armazemFrequencia(antenas, i);
+    int32_t x = armazemX(antenas, i);
+    int32_t y = armazemY(antenas, i);
+    fwrite(&frequencia, sizeof(char), 1, f);
+    fwrite(&x, sizeof(int32_t), 1, f);
+    fwrite(&y, sizeof(int32_t), 1, f);
+}
+
 /**
  * @brief Guarda o grafo em um ficheiro binário.
  * @param nomeFicheiro Nome do ficheiro onde o grafo será guardado.
@@ -227,6 +1294,7 @@ int guardarGrafoBinario(const char* nomeFicheiro, Vertice* grafo) {
  * @return 1 se o grafo foi guardado com sucesso, 0 caso contrário.
  */
 int guardarGrafoBinario(const char* nomeFicheiro, GR* grafo) {
+    if (!grafo) return 0;
     FILE* f = fopen(nomeFicheiro, "wb");
     if (!f) {
         perror("Erro ao abrir ficheiro binário");
@@ -234,7 +1302,7 @@ int guardarGrafoBinario(const char* nomeFicheiro, GR* grafo) {
     }
 
     for (Vertice* v = grafo->vertices; v != NULL; v = v->proximo) {
-        fwrite(&v->info, sizeof(Antena), 1, f);
+        escreverAntena(f, grafo->antenas, v->antena);
 
         int numArestas = 0;
         for (Aresta* a = v->adj; a != NULL; a = a->prox)
@@ -244,7 +1312,7 @@ int guardarGrafoBinario(const char* nomeFicheiro, GR* grafo) {
 
         for (Aresta* a = v->adj; a != NULL; a = a->prox) {
             fwrite(&a->distancia, sizeof(float), 1, f);
-            fwrite(&a->destino->info, sizeof(Antena), 1, f);
+            escreverAntena(f, grafo->antenas, a->destino->antena);
         }
     }
 
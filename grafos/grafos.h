@@ -10,6 +10,7 @@
 
 #include "../Fase1/antenas/antenas.h"
 #include "../Fase1/efeitos/efeitos.h"
+#include "grelha.h"
 
 #define MAX_ANTENAS 100
 
@@ -17,6 +18,7 @@
 typedef struct Vertice Vertice;
 typedef struct Aresta Aresta;
 typedef struct GR GR;
+typedef struct MapaVertices MapaVertices;
 
 /**
  * @brief Estrutura que representa uma aresta do grafo.
@@ -29,45 +31,222 @@ struct Aresta {
 
 /**
  * @brief Estrutura que representa um vértice do grafo (uma antena).
+ *
+ * A antena não é copiada: o vértice guarda apenas o seu índice no armazém do grafo.
+ * O que só serve às alterações (vértice anterior na lista, posição no grupo) fica em
+ * vetores do grafo indexados por antena, pelo que o vértice ocupa 24 bytes.
  */
 struct Vertice {
-    Antena info;
     Aresta* adj;
     Vertice* proximo;
+    uint32_t antena; //Índice da antena no armazém do grafo
     int visitado;
 };
 
+/**
+ * @brief Índices do armazém das antenas de uma frequência.
+ */
+typedef struct GrupoIndices {
+    uint32_t* indices; //Índices das antenas do grupo (sem ordem definida)
+    uint32_t num; //Número de índices
+    uint32_t capacidade; //Capacidade do vetor de índices
+} GrupoIndices;
+
+/**
+ * @brief Regra usada para ligar antenas da mesma frequência.
+ */
+typedef enum ModoLigacao {
+    LIGACAO_GRUPO, //Todas as antenas da mesma frequência
+    LIGACAO_RAIO, //Antenas da mesma frequência a uma distância até ao raio
+    LIGACAO_K_PROXIMOS //As k antenas mais próximas da mesma frequência
+} ModoLigacao;
+
 /**
  * @brief Estrutura que representa o grafo.
  */
 struct GR {
     Vertice* vertices; //Lista de vértices
     int numVertices; //Número de vértices no grafo
+    ArmazemAntenas* antenas; //Registos compactos das antenas dos vértices
+    Vertice** porIndice; //Vértice de cada índice do armazém (NULL se removido)
+    uint32_t* anteriorIndice; //Índice do vértice anterior na lista de vértices (UINT32_MAX no primeiro)
+    uint32_t* posicaoGrupo; //Posição de cada índice no grupo da sua frequência
+    uint64_t* versaoIndice; //Versão da última alteração da adjacência de cada índice
+    uint32_t capIndice; //Capacidade dos vetores indexados por antena
+    MapaVertices* mapa; //Tabela de dispersão (x,y) -> vértice
+    GrupoIndices grupos[256]; //Índices de cada frequência (os vizinhos possíveis nas alterações)
+    uint64_t versao; //Número de alterações feitas (cada vista CSR guarda a versão que reflete)
+    ModoLigacao modo; //Regra de ligação usada na construção e nas alterações
+    float raio; //Distância máxima (LIGACAO_RAIO)
+    int k; //Número de vizinhos (LIGACAO_K_PROXIMOS)
 };
 
+/**
+ * @brief Vista CSR (compressed sparse row) da adjacência do grafo.
+ *
+ * As arestas do vértice com índice de antena i ocupam as posições
+ * inicio[i] até inicio[i + 1] - 1 de destinos e distancias.
+ */
+typedef struct GrafoCSR {
+    uint32_t numVertices; //Número de índices de antena cobertos
+    uint32_t numArestas; //Número total de arestas (dirigidas)
+    uint32_t* inicio; //Início da linha de cada índice (numVertices + 1 posições)
+    uint32_t* destinos; //Índice de antena do destino de cada aresta
+    float* distancias; //Distância de cada aresta
+    uint64_t versao; //Versão do grafo refletida pela vista
+} GrafoCSR;
+
 // Construção e criação
 /**
  * @brief Constrói um grafo a partir de uma lista de antenas.
  * @param listaAntenas Lista ligada de antenas.
- * @return Ponteiro para o grafo construído.
+ * @return Ponteiro para o grafo construído, ou NULL em caso de erro.
  */
 GR* construirGrafo(Antena* listaAntenas);
 
+/**
+ * @brief Constrói um grafo que só liga antenas da mesma frequência até uma distância máxima.
+ *
+ * Os vizinhos são procurados numa grelha uniforme com células de lado igual ao raio,
+ * pelo que só são comparadas antenas em células adjacentes.
+ * @param listaAntenas Lista ligada de antenas.
+ * @param raio Distância máxima entre antenas ligadas.
+ * @return Ponteiro para o grafo construído, ou NULL em caso de erro.
+ */
+GR* construirGrafoRaio(Antena* listaAntenas, float raio);
+
+/**
+ * @brief Constrói um grafo que liga cada antena às k antenas mais próximas da mesma frequência.
+ *
+ * As arestas são simétricas: a e b ficam ligadas se b for vizinha de a ou a for vizinha de b.
+ * Os vizinhos são procurados em anéis crescentes de células de uma grelha uniforme.
+ * @param listaAntenas Lista ligada de antenas.
+ * @param k Número de vizinhos por antena.
+ * @return Ponteiro para o grafo construído, ou NULL em caso de erro.
+ */
+GR* construirGrafoKProximos(Antena* listaAntenas, int k);
+
+/**
+ * @brief Cria um grafo com um vértice por antena do armazém e sem arestas.
+ * @param antenas Armazém de antenas (passa a pertencer ao grafo em caso de sucesso).
+ * @return Ponteiro para o grafo, ou NULL em caso de erro.
+ */
+GR* criarGrafoSemArestas(ArmazemAntenas* antenas);
+
+/**
+ * @brief Cria um grafo a partir de vértices já construídos (com as respetivas arestas).
+ *
+ * Os vértices são ligados na lista pela ordem dos índices do armazém.
+ * @param antenas Armazém de antenas.
+ * @param vertices Vértice de cada índice do armazém (NULL se não existir).
+ * @return Ponteiro para o grafo, ou NULL em caso de erro. Em caso de sucesso, o armazém e os
+ *         vértices passam a pertencer ao grafo; em caso de erro continuam a pertencer a quem chama.
+ */
+GR* criarGrafoComVertices(ArmazemAntenas* antenas, Vertice** vertices);
+
 /**
  * @brief Insere um novo vértice (antena) na lista de vértices do grafo.
  * @param lista Lista ligada de vértices.
- * @param a Estrutura Antena a ser inserida.
+ * @param antena Índice da antena no armazém do grafo.
  * @return Ponteiro para o novo vértice inserido.
  */
-Vertice* inserirVertice(Vertice* lista, Antena a);
+Vertice* inserirVertice(Vertice* lista, uint32_t antena);
+
+/**
+ * @brief Calcula a distância euclidiana entre duas posições do mapa.
+ * @param ax Coordenada X da primeira posição.
+ * @param ay Coordenada Y da primeira posição.
+ * @param bx Coordenada X da segunda posição.
+ * @param by Coordenada Y da segunda posição.
+ * @return Distância entre as duas posições.
+ */
+float distanciaPontos(int ax, int ay, int bx, int by);
+
+/**
+ * @brief Calcula a distância euclidiana entre duas antenas do armazém.
+ * @param antenas Armazém de antenas.
+ * @param a Índice da primeira antena.
+ * @param b Índice da segunda antena.
+ * @return Distância entre as duas antenas.
+ */
+float calcularDistancia(const ArmazemAntenas* antenas, uint32_t a, uint32_t b);
 
 /**
  * @brief Adiciona uma aresta entre dois vértices (antenas) no grafo.
+ * @param grafo Grafo a que pertencem os vértices.
  * @param origem Vértice de origem.
  * @param destino Vértice de destino.
  * @return 1 se a aresta foi adicionada com sucesso, 0 caso contrário.
  */
-int adicionarAresta(Vertice* origem, Vertice* destino);
+int adicionarAresta(GR* grafo, Vertice* origem, Vertice* destino);
+
+// Alterações incrementais
+/**
+ * @brief Procura o vértice de uma antena a partir das suas coordenadas.
+ * @param grafo Ponteiro para o grafo.
+ * @param x Coordenada X da antena.
+ * @param y Coordenada Y da antena.
+ * @return Vértice da antena, ou NULL se não existir.
+ */
+Vertice* procurarVertice(GR* grafo, int x, int y);
+
+/**
+ * @brief Acrescenta uma antena ao grafo e liga-a apenas ao seu grupo de frequência.
+ *
+ * Respeita o modo de ligação do grafo; no modo LIGACAO_K_PROXIMOS a nova antena é ligada às
+ * suas k mais próximas, sem retirar vizinhos às restantes.
+ * @param grafo Ponteiro para o grafo.
+ * @param frequencia Frequência da nova antena.
+ * @param x Coordenada X da nova antena.
+ * @param y Coordenada Y da nova antena.
+ * @return Novo vértice, ou NULL se a posição estiver ocupada ou houver erro (o grafo não muda).
+ */
+Vertice* grafoAdicionarAntena(GR* grafo, char frequencia, int x, int y);
+
+/**
+ * @brief Remove uma antena do grafo, assim como todas as suas arestas.
+ * @param grafo Ponteiro para o grafo.
+ * @param x Coordenada X da antena.
+ * @param y Coordenada Y da antena.
+ * @return 1 se a antena foi removida, 0 caso contrário.
+ */
+int grafoRemoverAntena(GR* grafo, int x, int y);
+
+/**
+ * @brief Muda a frequência de uma antena, passando-a para outro grupo de frequência.
+ * @param grafo Ponteiro para o grafo.
+ * @param x Coordenada X da antena.
+ * @param y Coordenada Y da antena.
+ * @param frequencia Nova frequência.
+ * @return 1 se a frequência foi alterada, 0 caso contrário (em caso de erro o grafo não muda).
+ */
+int grafoAlterarFrequencia(GR* grafo, int x, int y, char frequencia);
+
+// Vista CSR
+/**
+ * @brief Constrói a vista CSR do grafo, que fica com a versão atual do grafo.
+ * @param grafo Ponteiro para o grafo.
+ * @return Vista CSR, ou NULL em caso de erro.
+ */
+GrafoCSR* construirCSR(GR* grafo);
+
+/**
+ * @brief Aplica à vista CSR, de uma só vez, todas as alterações feitas no grafo desde a versão da vista.
+ *
+ * Apenas as linhas dos vértices alterados são lidas das listas de adjacência;
+ * as restantes são copiadas da vista anterior. Cada vista guarda a sua versão, pelo que
+ * várias vistas do mesmo grafo podem ser sincronizadas em momentos diferentes.
+ * @param csr Vista CSR a atualizar.
+ * @param grafo Ponteiro para o grafo.
+ * @return 1 se a vista foi atualizada, 0 caso contrário.
+ */
+int aplicarDeltasCSR(GrafoCSR* csr, GR* grafo);
+
+/**
+ * @brief Liberta a memória de uma vista CSR.
+ * @param csr Vista CSR.
+ */
+void libertarCSR(GrafoCSR* csr);
 
 // Visualização
 /**
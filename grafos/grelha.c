@@ -0,0 +1,112 @@
+/**
+ * @author Tomás Cerqueira Gomes (a31501@alunos.ipca.pt)
+ * @date 2025-05-18
+ * 
+ * @file grelha.c
+ * @brief Implementação da grelha espacial uniforme.
+*/
+
+#include "grelha.h"
+#include <math.h>
+
+#pragma region dispersarCelula
+/**
+ * @brief Calcula o balde de uma célula.
+ * @param cx Célula no eixo X.
+ * @param cy Célula no eixo Y.
+ * @param mascara Número de baldes - 1.
+ * @return Índice do balde.
+ */
+static uint32_t dispersarCelula(int64_t cx, int64_t cy, uint32_t mascara) {
+    uint64_t h = (uint64_t)cx * 0x9E3779B97F4A7C15ULL ^ (uint64_t)cy * 0xC2B2AE3D27D4EB4FULL;
+    h ^= h >> 29;
+    return (uint32_t)h & mascara;
+}
+#pragma endregion
+
+#pragma region criarGrelha
+/**
+ * @brief Cria uma grelha com as antenas indicadas (contagem por balde e soma prefixa).
+ * @param antenas Armazém de antenas.
+ * @param indices Índices das antenas a colocar na grelha.
+ * @param n Número de índices.
+ * @param tamanho Lado de cada célula (maior que 0).
+ * @return Ponteiro para a grelha, ou NULL em caso de erro.
+ */
+GrelhaEspacial* criarGrelha(const ArmazemAntenas* antenas, const uint32_t* indices, uint32_t n, float tamanho) {
+    if (!antenas || !(tamanho > 0)) return NULL;
+    GrelhaEspacial* grelha = reservarMemoriaZeros(MEM_OUTROS, 1, sizeof(GrelhaEspacial));
+    if (!grelha) return NULL;
+
+    uint32_t baldes = 16;
+    while (baldes < n && baldes < 0x80000000u) baldes *= 2;
+    grelha->antenas = antenas;
+    grelha->tamanho = tamanho;
+    grelha->mascara = baldes - 1;
+    grelha->num = n;
+    grelha->inicio = reservarMemoriaZeros(MEM_OUTROS, (size_t)baldes + 1, sizeof(uint32_t));
+    grelha->itens = reservarMemoria(MEM_OUTROS, (size_t)(n ? n : 1) * sizeof(uint32_t));
+    uint32_t* balde = reservarMemoria(MEM_OUTROS, (size_t)(n ? n : 1) * sizeof(uint32_t));
+    if (!grelha->inicio || !grelha->itens || !balde) {
+        libertarMemoria(MEM_OUTROS, balde, (size_t)(n ? n : 1) * sizeof(uint32_t));
+        libertarGrelha(grelha);
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < n; i++) {
+        balde[i] = dispersarCelula(grelhaCelula(grelha, armazemX(antenas, indices[i])),
+                                   grelhaCelula(grelha, armazemY(antenas, indices[i])), grelha->mascara);
+        grelha->inicio[balde[i] + 1]++;
+    }
+    for (uint32_t b = 0; b < baldes; b++) grelha->inicio[b + 1] += grelha->inicio[b];
+
+    // Preenchimento estável: reutiliza inicio como cursor e depois repõe-no
+    for (uint32_t i = 0; i < n; i++) grelha->itens[grelha->inicio[balde[i]]++] = indices[i];
+    for (uint32_t b = baldes; b > 0; b--) grelha->inicio[b] = grelha->inicio[b - 1];
+    grelha->inicio[0] = 0;
+
+    libertarMemoria(MEM_OUTROS, balde, (size_t)(n ? n : 1) * sizeof(uint32_t));
+    return grelha;
+}
+#pragma endregion
+
+#pragma region grelhaCelula
+/**
+ * @brief Calcula a célula de uma coordenada.
+ * @param grelha Ponteiro para a grelha.
+ * @param coordenada Coordenada X ou Y.
+ * @return Índice da célula nesse eixo.
+ */
+int64_t grelhaCelula(const GrelhaEspacial* grelha, int coordenada) {
+    return (int64_t)floor((double)coordenada / grelha->tamanho);
+}
+#pragma endregion
+
+#pragma region grelhaBalde
+/**
+ * @brief Obtém as antenas do balde onde cai uma célula.
+ * @param grelha Ponteiro para a grelha.
+ * @param cx Célula no eixo X.
+ * @param cy Célula no eixo Y.
+ * @param itens Ponteiro onde é devolvido o primeiro índice do balde.
+ * @return Número de antenas no balde.
+ */
+uint32_t grelhaBalde(const GrelhaEspacial* grelha, int64_t cx, int64_t cy, const uint32_t** itens) {
+    uint32_t b = dispersarCelula(cx, cy, grelha->mascara);
+    *itens = &grelha->itens[grelha->inicio[b]];
+    return grelha->inicio[b + 1] - grelha->inicio[b];
+}
+#pragma endregion
+
+#pragma region libertarGrelha
+/**
+ * @brief Liberta a memória da grelha (o armazém não é libertado).
+ * @param grelha Ponteiro para a grelha.
+ */
+void libertarGrelha(GrelhaEspacial* grelha) {
+    if (!grelha) return;
+    libertarMemoria(MEM_OUTROS, grelha->inicio, ((size_t)grelha->mascara + 2) * sizeof(uint32_t));
+    libertarMemoria(MEM_OUTROS, grelha->itens, (size_t)(grelha->num ? grelha->num : 1) * sizeof(uint32_t));
+    libertarMemoria(MEM_OUTROS, grelha, sizeof(GrelhaEspacial));
+}
+#pragma endregion
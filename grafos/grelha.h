@@ -0,0 +1,65 @@
+/**
+ * @author Tomás Cerqueira Gomes (a31501@alunos.ipca.pt)
+ * @date 2025-05-18
+ * 
+ * @file grelha.h
+ * @brief Grelha espacial uniforme para procurar antenas próximas.
+*/
+#ifndef GRELHA_H
+#define GRELHA_H
+
+#include <stdint.h>
+#include "../Fase1/antenas/antenas.h"
+
+/**
+ * @brief Grelha uniforme com células quadradas, guardada por dispersão em baldes.
+ *
+ * Cada antena pertence à célula (floor(x / tamanho), floor(y / tamanho)). As células são
+ * dispersas por um número de baldes proporcional ao número de antenas, pelo que um balde
+ * pode conter antenas de várias células: quem percorre um balde deve confirmar a célula
+ * com grelhaCelula.
+ */
+typedef struct GrelhaEspacial {
+    const ArmazemAntenas* antenas; //Armazém a que os índices se referem
+    float tamanho; //Lado de cada célula
+    uint32_t mascara; //Número de baldes - 1 (potência de 2)
+    uint32_t* inicio; //Início de cada balde em itens (número de baldes + 1 posições)
+    uint32_t* itens; //Índices de antena ordenados por balde
+    uint32_t num; //Número de índices em itens
+} GrelhaEspacial;
+
+/**
+ * @brief Cria uma grelha com as antenas indicadas.
+ * @param antenas Armazém de antenas.
+ * @param indices Índices das antenas a colocar na grelha.
+ * @param n Número de índices.
+ * @param tamanho Lado de cada célula (maior que 0).
+ * @return Ponteiro para a grelha, ou NULL em caso de erro.
+ */
+GrelhaEspacial* criarGrelha(const ArmazemAntenas* antenas, const uint32_t* indices, uint32_t n, float tamanho);
+
+/**
+ * @brief Calcula a célula de uma coordenada.
+ * @param grelha Ponteiro para a grelha.
+ * @param coordenada Coordenada X ou Y.
+ * @return Índice da célula nesse eixo.
+ */
+int64_t grelhaCelula(const GrelhaEspacial* grelha, int coordenada);
+
+/**
+ * @brief Obtém as antenas do balde onde cai uma célula.
+ * @param grelha Ponteiro para a grelha.
+ * @param cx Célula no eixo X.
+ * @param cy Célula no eixo Y.
+ * @param itens Ponteiro onde é devolvido o primeiro índice do balde.
+ * @return Número de antenas no balde.
+ */
+uint32_t grelhaBalde(const GrelhaEspacial* grelha, int64_t cx, int64_t cy, const uint32_t** itens);
+
+/**
+ * @brief Liberta a memória da grelha (o armazém não é libertado).
+ * @param grelha Ponteiro para a grelha.
+ */
+void libertarGrelha(GrelhaEspacial* grelha);
+
+#endif
@@ -8,9 +8,70 @@
 
 #include "../Fase1/antenas/antenas.h"
 #include "grafos.h"
+#include "mst.h"
+#include "pipeline.h"
+#include "vigia.h"
+#include "construcao.h"
+#include "pesquisa.h"
+#include <signal.h>
 #include <stdio.h>
+#include <string.h>
+
+static volatile sig_atomic_t interrompido = 0; //1 depois de um SIGINT no modo de vigia
+
+/**
+ * @brief Regista o SIGINT para o modo de vigia terminar e libertar o estado.
+ */
+static void tratarInterrupcao(int sinal) {
+    (void)sinal;
+    interrompido = 1;
+}
+
+/**
+ * @brief Mostra o resumo de cada atualização do modo de vigia.
+ * @return 0 depois de um SIGINT (para parar de vigiar), 1 caso contrário.
+ */
+static int mostrarAtualizacao(EstadoVigia* estado, const AlteracoesVigia* alteracoes, void* arg) {
+    (void)arg;
+    if (interrompido) return 0;
+    if (!alteracoes) return 1;
+    printf("%d linha(s) alterada(s): +%d / -%d antenas%s | %d antenas, %u efeitos | %.2f ms\n",
+           alteracoes->linhasAlteradas, alteracoes->antenasAdicionadas, alteracoes->antenasRemovidas,
+           alteracoes->reconstruido ? " (reconstruido)" : alteracoes->efeitosRecalculados ? " (efeitos recalculados)" : "",
+           estado->grafo->numVertices,
+           estado->efeitos->numEfeitos, alteracoes->milissegundos);
+    fflush(stdout);
+    return !interrompido;
+}
+
+int main(int argc, char* argv[]) {
+    // Modo de vigia: ./programa --vigiar [ficheiro]
+    if (argc > 1 && strcmp(argv[1], "--vigiar") == 0) {
+        const char* ficheiro = argc > 2 ? argv[2] : "antenas.txt";
+        EstadoVigia* vigia = criarVigia(ficheiro);
+        if (!vigia) {
+            printf("Erro ao carregar antenas.\n");
+            return 1;
+        }
+        // Sem SA_RESTART, para que o SIGINT interrompa a espera do inotify
+        struct sigaction acao;
+        memset(&acao, 0, sizeof(acao));
+        acao.sa_handler = tratarInterrupcao;
+        sigemptyset(&acao.sa_mask);
+        sigaction(SIGINT, &acao, NULL);
+
+        printf("A vigiar %s (%d antenas, %u efeitos). Ctrl+C para terminar.\n", ficheiro,
+               vigia->grafo->numVertices, vigia->efeitos->numEfeitos);
+        fflush(stdout);
+        int parado = vigiarFicheiro(vigia, mostrarAtualizacao, NULL);
+        libertarVigia(vigia);
+        if (!parado) {
+            printf("Erro ao vigiar %s.\n", ficheiro);
+            return 1;
+        }
+        return 0;
+    }
 
-int main() {
     // Carregar antenas
     Antena* listaAntenas = carregarAntenasDeFicheiro("antenas.txt");
     if (!listaAntenas) {
@@ -20,11 +81,38 @@ int main() {
 
     // Construir grafo
     GR* grafo = construirGrafo(listaAntenas);
+    if (!grafo) {
+        printf("Erro ao construir o grafo.\n");
+        limparLista(listaAntenas);
+        return 1;
+    }
 
     // Mostrar grafo
     printf("\n=== GRAFO ===\n");
     mostrarGrafo(grafo);
 
+    // Grafos esparsos (raio e k vizinhos mais próximos)
+    GR* grafoRaio = construirGrafoRaio(listaAntenas, 3.0f);
+    printf("\n=== GRAFO (RAIO 3) ===\n");
+    mostrarGrafo(grafoRaio);
+    libertarGrafo(grafoRaio);
+
+    GR* grafoK = construirGrafoKProximos(listaAntenas, 1);
+    printf("\n=== GRAFO (K = 1) ===\n");
+    mostrarGrafo(grafoK);
+    libertarGrafo(grafoK);
+
+    // Árvore geradora mínima de cada frequência
+    uint32_t numArestasMST;
+    ArestaMST* mst = arvoreMinimaPorFrequencia(grafo->antenas, 0, 0, &numArestasMST);
+    printf("\n=== ARVORE GERADORA MINIMA ===\n");
+    for (uint32_t i = 0; i < numArestasMST; i++) {
+        printf("%c (%d,%d) - (%d,%d): %.2f\n", armazemFrequencia(grafo->antenas, mst[i].a),
+               armazemX(grafo->antenas, mst[i].a), armazemY(grafo->antenas, mst[i].a),
+               armazemX(grafo->antenas, mst[i].b), armazemY(grafo->antenas, mst[i].b), mst[i].distancia);
+    }
+    libertarArvoreMinima(mst, numArestasMST);
+
     // DFS
     printf("\n=== DFS ===\n");
     limparVisitados(grafo);
@@ -35,6 +123,60 @@ int main() {
     limparVisitados(grafo);
     bfs(grafo, grafo->vertices); // começa pela primeira antena
 
+    // Alterações incrementais
+    printf("\n=== GRAFO APOS ALTERACOES ===\n");
+    grafoAdicionarAntena(grafo, 'A', 3, 3);
+    grafoAlterarFrequencia(grafo, 4, 4, 'A');
+    grafoRemoverAntena(grafo, 9, 9);
+    mostrarGrafo(grafo);
+
+    // Leitura em pipeline (efeitos e grafo calculados durante a leitura)
+    ResultadoPipeline pipeline;
+    if (carregarEmPipeline("antenas.txt", 0, &pipeline)) {
+        int numEfeitos = 0;
+        for (Efeito* e = pipeline.efeitos; e; e = e->prox) numEfeitos++;
+        printf("\n=== LEITURA EM PIPELINE ===\n");
+        printf("Mapa %dx%d: %d antenas, %d efeitos harmonicos\n", pipeline.largura, pipeline.altura,
+               pipeline.grafo->numVertices, numEfeitos);
+        libertarResultadoPipeline(&pipeline);
+    }
+
+    // Construção em paralelo (mesmas arestas que construirGrafo)
+    GR* grafoParalelo = construirGrafoParalelo(listaAntenas, 0);
+    GrafoCSR* csrParalelo = grafoParalelo ? construirCSRParalelo(grafoParalelo->antenas, 0) : NULL;
+    if (csrParalelo) {
+        printf("\n=== CONSTRUCAO EM PARALELO ===\n");
+        printf("%d vertices, %u arestas\n", grafoParalelo->numVertices, csrParalelo->numArestas);
+    }
+    libertarCSR(csrParalelo);
+    libertarGrafo(grafoParalelo);
+
+    // Pesquisa em largura em paralelo: saltos até à primeira antena de cada frequência (grafo de raio 3)
+    GR* grafoSaltos = construirGrafoRaio(listaAntenas, 3.0f);
+    GrafoCSR* csrSaltos = grafoSaltos ? construirCSR(grafoSaltos) : NULL;
+    uint32_t origens[256];
+    uint32_t numOrigens = 0;
+    int vista[256] = {0};
+    for (Vertice* v = grafoSaltos ? grafoSaltos->vertices : NULL; v; v = v->proximo) {
+        unsigned char f = (unsigned char)armazemFrequencia(grafoSaltos->antenas, v->antena);
+        if (!vista[f]) {
+            vista[f] = 1;
+            origens[numOrigens++] = v->antena;
+        }
+    }
+    ResultadoBFS saltos;
+    if (csrSaltos && bfsParalelo(csrSaltos, origens, numOrigens, 0, &saltos)) {
+        printf("\n=== BFS EM PARALELO (RAIO 3) ===\n");
+        for (Vertice* v = grafoSaltos->vertices; v; v = v->proximo) {
+            printf("%c (%d,%d): %d\n", armazemFrequencia(grafoSaltos->antenas, v->antena),
+                   armazemX(grafoSaltos->antenas, v->antena), armazemY(grafoSaltos->antenas, v->antena),
+                   saltos.distancias[v->antena]);
+        }
+        libertarResultadoBFS(&saltos);
+    }
+    libertarCSR(csrSaltos);
+    libertarGrafo(grafoSaltos);
+
     // Guardar ficheiro binário
     guardarGrafoBinario("grafo.bin", grafo);
 
@@ -0,0 +1,468 @@
+/**
+ * @author Tomás Cerqueira Gomes (a31501@alunos.ipca.pt)
+ * @date 2025-05-18
+ * 
+ * @file mst.c
+ * @brief Implementação da árvore geradora mínima por frequência (Borůvka sobre uma árvore k-d).
+*/
+
+#include "mst.h"
+#include "grafos.h"
+#include "paralelo.h"
+#include <stdatomic.h>
+
+#pragma region UniaoConjuntos
+/**
+ * @brief Estrutura union-find sobre as posições de um grupo de frequência.
+ */
+typedef struct UniaoConjuntos {
+    uint32_t* pai; //Pai de cada elemento
+    uint8_t* ordem; //Limite superior da altura de cada raiz
+    uint32_t numConjuntos; //Número de conjuntos disjuntos
+} UniaoConjuntos;
+
+/**
+ * @brief Devolve a raiz do conjunto de x (com compressão por divisão do caminho).
+ */
+static uint32_t encontrar(UniaoConjuntos* u, uint32_t x) {
+    while (u->pai[x] != x) {
+        u->pai[x] = u->pai[u->pai[x]];
+        x = u->pai[x];
+    }
+    return x;
+}
+
+/**
+ * @brief Junta os conjuntos de a e b.
+ * @return 1 se estavam em conjuntos diferentes, 0 caso contrário.
+ */
+static int unir(UniaoConjuntos* u, uint32_t a, uint32_t b) {
+    a = encontrar(u, a);
+    b = encontrar(u, b);
+    if (a == b) return 0;
+    if (u->ordem[a] < u->ordem[b]) {
+        uint32_t aux = a;
+        a = b;
+        b = aux;
+    }
+    u->pai[b] = a;
+    if (u->ordem[a] == u->ordem[b]) u->ordem[a]++;
+    u->numConjuntos--;
+    return 1;
+}
+#pragma endregion
+
+#pragma region ListaArestas
+/**
+ * @brief Vetor de arestas com a capacidade reservada de uma vez (m - 1 por grupo).
+ */
+typedef struct ListaArestas {
+    ArestaMST* arestas;
+    size_t num;
+    size_t capacidade;
+} ListaArestas;
+
+/**
+ * @brief Acrescenta uma aresta ao vetor.
+ *
+ * Uma árvore de m antenas tem exatamente m - 1 arestas, pelo que a capacidade reservada
+ * em arvoreMinimaPorFrequencia chega sempre e o vetor nunca é realocado.
+ * @return 1 em caso de sucesso, 0 se a capacidade estiver esgotada.
+ */
+static int acrescentarAresta(ListaArestas* l, uint32_t a, uint32_t b, float distancia) {
+    if (l->num == l->capacidade) return 0;
+    l->arestas[l->num++] = (ArestaMST){ a, b, distancia };
+    return 1;
+}
+
+/**
+ * @brief Ordem total das arestas: distância, depois índices (resultado determinista).
+ */
+static int compararArestas(const void* p, const void* q) {
+    const ArestaMST* x = p;
+    const ArestaMST* y = q;
+    if (x->distancia != y->distancia) return x->distancia < y->distancia ? -1 : 1;
+    if (x->a != y->a) return x->a < y->a ? -1 : 1;
+    return (x->b > y->b) - (x->b < y->b);
+}
+#pragma endregion
+
+#pragma region ArvoreKd
+#define KD_FOLHA 8 //Número máximo de antenas numa folha
+#define KD_MISTO UINT32_MAX //Componente de um nó com antenas de várias componentes
+
+/**
+ * @brief Nó da árvore k-d sobre as posições de um grupo de frequência.
+ */
+typedef struct NoKd {
+    int minX, maxX, minY, maxY; //Retângulo envolvente das antenas do nó
+    uint32_t inicio, fim; //Intervalo do nó no vetor ordem
+    uint32_t filho; //Índice do filho esquerdo (o direito é o seguinte), ou 0 numa folha
+    uint32_t componente; //Componente comum a todas as antenas do nó, ou KD_MISTO
+} NoKd;
+
+/**
+ * @brief Árvore k-d de um grupo e estado de uma ronda de Borůvka.
+ */
+typedef struct ArvoreKd {
+    const ArmazemAntenas* antenas;
+    const uint32_t* grupo; //Índices das antenas do grupo
+    int* coordenadas; //Coordenadas (x, y) de cada posição, seguidas
+    uint32_t* ordem; //Posições no grupo, pela ordem das folhas
+    NoKd* nos;
+    uint32_t numNos;
+    uint32_t* componente; //Raiz da componente de cada posição (atualizada em cada ronda)
+    uint32_t* melhorQ; //Posição mais próxima noutra componente, por posição (UINT32_MAX se não houver)
+    uint64_t* melhorD; //Quadrado da distância correspondente
+    _Atomic uint64_t* limite; //Menor quadrado já encontrado por cada componente (indexado pela raiz)
+    uint32_t m; //Número de antenas do grupo
+} ArvoreKd;
+
+/**
+ * @brief Coordenada de uma posição do grupo no eixo indicado (0 = x, 1 = y).
+ */
+static inline int coordenadaKd(const ArvoreKd* kd, uint32_t p, int eixo) {
+    return kd->coordenadas[2 * (size_t)p + eixo];
+}
+
+/**
+ * @brief Reordena ordem[inicio, fim[ de forma a que o elemento de índice k fique no lugar
+ *        que teria com o vetor ordenado pelo eixo indicado (quickselect).
+ */
+static void selecionarKd(ArvoreKd* kd, uint32_t inicio, uint32_t fim, uint32_t k, int eixo) {
+    uint32_t* o = kd->ordem;
+    while (fim - inicio > 1) {
+        int pivo = coordenadaKd(kd, o[inicio + (fim - inicio) / 2], eixo);
+        uint32_t i = inicio, j = fim - 1;
+        while (i <= j) {
+            while (coordenadaKd(kd, o[i], eixo) < pivo) i++;
+            while (coordenadaKd(kd, o[j], eixo) > pivo) j--;
+            if (i <= j) {
+                uint32_t aux = o[i];
+                o[i] = o[j];
+                o[j] = aux;
+                i++;
+                if (j == 0) break;
+                j--;
+            }
+        }
+        if (k <= j) fim = j + 1;
+        else if (k >= i) inicio = i;
+        else return;
+    }
+}
+
+/**
+ * @brief Constrói o nó no com as posições ordem[inicio, fim[, dividindo pela mediana do maior lado.
+ */
+static void construirNoKd(ArvoreKd* kd, uint32_t no, uint32_t inicio, uint32_t fim) {
+    NoKd* n = &kd->nos[no];
+    n->inicio = inicio;
+    n->fim = fim;
+    n->filho = 0;
+    n->minX = n->maxX = coordenadaKd(kd, kd->ordem[inicio], 0);
+    n->minY = n->maxY = coordenadaKd(kd, kd->ordem[inicio], 1);
+    for (uint32_t t = inicio + 1; t < fim; t++) {
+        int x = coordenadaKd(kd, kd->ordem[t], 0), y = coordenadaKd(kd, kd->ordem[t], 1);
+        if (x < n->minX) n->minX = x;
+        if (x > n->maxX) n->maxX = x;
+        if (y < n->minY) n->minY = y;
+        if (y > n->maxY) n->maxY = y;
+    }
+    if (fim - inicio <= KD_FOLHA) return;
+
+    int eixo = (int64_t)n->maxY - n->minY > (int64_t)n->maxX - n->minX;
+    uint32_t meio = inicio + (fim - inicio) / 2;
+    selecionarKd(kd, inicio, fim, meio, eixo);
+    uint32_t filho = kd->numNos;
+    kd->numNos += 2;
+    kd->nos[no].filho = filho;
+    construirNoKd(kd, filho, inicio, meio);
+    construirNoKd(kd, filho + 1, meio, fim);
+}
+
+/**
+ * @brief Atualiza a componente comum de cada nó (os filhos têm sempre índice maior que o pai).
+ */
+static void etiquetarNosKd(ArvoreKd* kd) {
+    for (uint32_t no = kd->numNos; no-- > 0;) {
+        NoKd* n = &kd->nos[no];
+        if (n->filho) {
+            uint32_t a = kd->nos[n->filho].componente, b = kd->nos[n->filho + 1].componente;
+            n->componente = a == b ? a : KD_MISTO;
+            continue;
+        }
+        n->componente = kd->componente[kd->ordem[n->inicio]];
+        for (uint32_t t = n->inicio + 1; t < n->fim && n->componente != KD_MISTO; t++) {
+            if (kd->componente[kd->ordem[t]] != n->componente) n->componente = KD_MISTO;
+        }
+    }
+}
+
+/**
+ * @brief Quadrado da distância entre as antenas a e b (exato para coordenadas int).
+ */
+static uint64_t distancia2Kd(const ArvoreKd* kd, uint32_t a, uint32_t b) {
+    uint64_t dx = (uint64_t)llabs((int64_t)coordenadaKd(kd, a, 0) - coordenadaKd(kd, b, 0));
+    uint64_t dy = (uint64_t)llabs((int64_t)coordenadaKd(kd, a, 1) - coordenadaKd(kd, b, 1));
+    return dx * dx + dy * dy;
+}
+
+/**
+ * @brief Quadrado da menor distância entre a posição p e o retângulo de um nó.
+ */
+static uint64_t distancia2NoKd(const ArvoreKd* kd, uint32_t p, const NoKd* n) {
+    int64_t x = coordenadaKd(kd, p, 0), y = coordenadaKd(kd, p, 1);
+    uint64_t dx = x < n->minX ? (uint64_t)(n->minX - x) : x > n->maxX ? (uint64_t)(x - n->maxX) : 0;
+    uint64_t dy = y < n->minY ? (uint64_t)(n->minY - y) : y > n->maxY ? (uint64_t)(y - n->maxY) : 0;
+    return dx * dx + dy * dy;
+}
+
+/**
+ * @brief Ordem total das arestas de uma ronda: quadrado da distância, depois índices no armazém.
+ * @return 1 se a aresta (a, b) com quadrado d vem antes da aresta (c, e) com quadrado dce
+ *         (ou se c for UINT32_MAX, isto é, se ainda não houver aresta).
+ */
+static int antesKd(const ArvoreKd* kd, uint32_t a, uint32_t b, uint64_t d, uint32_t c, uint32_t e, uint64_t dce) {
+    if (c == UINT32_MAX) return 1;
+    if (d != dce) return d < dce;
+    uint32_t i = kd->grupo[a], j = kd->grupo[b], k = kd->grupo[c], l = kd->grupo[e];
+    uint32_t menor1 = i < j ? i : j, maior1 = i < j ? j : i;
+    uint32_t menor2 = k < l ? k : l, maior2 = k < l ? l : k;
+    return menor1 != menor2 ? menor1 < menor2 : maior1 < maior2;
+}
+
+/**
+ * @brief Procura, a partir do nó no, a posição mais próxima de p noutra componente.
+ *
+ * Os nós cuja componente comum é a de p são ignorados sem serem percorridos, pelo que
+ * um aglomerado já ligado custa um só passo. Os nós mais longe do que a melhor aresta já
+ * encontrada pela componente de p (em qualquer thread) também são ignorados: p pode ficar
+ * sem candidata, mas a menor aresta da componente é sempre encontrada pela sua extremidade.
+ */
+static void procurarKd(ArvoreKd* kd, uint32_t no, uint32_t p) {
+    const NoKd* n = &kd->nos[no];
+    uint32_t comp = kd->componente[p];
+    if (n->componente == comp) return;
+    uint64_t dNo = distancia2NoKd(kd, p, n);
+    if (dNo > atomic_load_explicit(&kd->limite[comp], memory_order_relaxed)) return;
+    if (kd->melhorQ[p] != UINT32_MAX && dNo > kd->melhorD[p]) return;
+
+    if (!n->filho) {
+        for (uint32_t t = n->inicio; t < n->fim; t++) {
+            uint32_t q = kd->ordem[t];
+            if (kd->componente[q] == comp) continue;
+            uint64_t d = distancia2Kd(kd, p, q);
+            uint32_t atual = kd->melhorQ[p];
+            if (antesKd(kd, p, q, d, atual == UINT32_MAX ? UINT32_MAX : p, atual, kd->melhorD[p])) {
+                kd->melhorQ[p] = q;
+                kd->melhorD[p] = d;
+                uint64_t limite = atomic_load_explicit(&kd->limite[comp], memory_order_relaxed);
+                while (d < limite && !atomic_compare_exchange_weak_explicit(&kd->limite[comp], &limite, d,
+                                                                           memory_order_relaxed,
+                                                                           memory_order_relaxed)) {
+                }
+            }
+        }
+        return;
+    }
+    uint32_t a = n->filho, b = n->filho + 1;
+    if (distancia2NoKd(kd, p, &kd->nos[b]) < distancia2NoKd(kd, p, &kd->nos[a])) {
+        a = b;
+        b = n->filho;
+    }
+    procurarKd(kd, a, p);
+    procurarKd(kd, b, p);
+}
+
+/**
+ * @brief Tarefa paralela: vizinho mais próximo noutra componente de cada posição de um bloco.
+ */
+static void procurarBlocoKd(int id, int numThreads, void* arg) {
+    ArvoreKd* kd = arg;
+    uint32_t inicio = (uint32_t)((uint64_t)kd->m * id / numThreads);
+    uint32_t fim = (uint32_t)((uint64_t)kd->m * (id + 1) / numThreads);
+    // Pela ordem das folhas, para que antenas vizinhas sejam procuradas seguidas
+    for (uint32_t t = inicio; t < fim; t++) {
+        uint32_t p = kd->ordem[t];
+        kd->melhorQ[p] = UINT32_MAX;
+        procurarKd(kd, 0, p);
+    }
+}
+#pragma endregion
+
+#pragma region arvoreMinimaGrupo
+/**
+ * @brief Calcula a árvore mínima de um grupo de frequência, acrescentando-a a arvore.
+ *
+ * Algoritmo de Borůvka sobre uma árvore k-d: em cada ronda cada antena procura a antena mais
+ * próxima noutra componente e cada componente junta-se pela menor dessas arestas. Com a ordem
+ * total (distância, índices) as arestas escolhidas pertencem todas à única árvore mínima nessa
+ * ordem. Há no máximo log2(m) rondas e cada uma guarda uma candidata por antena, pelo que a
+ * memória é O(m) mesmo com antenas muito aglomeradas.
+ * @param antenas Armazém de antenas.
+ * @param grupo Índices das antenas do grupo (por ordem crescente).
+ * @param m Número de antenas do grupo.
+ * @param numThreads Número de threads para a pesquisa e a ordenação.
+ * @param arvore Vetor onde são acrescentadas as arestas da árvore.
+ * @return 1 em caso de sucesso, 0 se faltar memória.
+ */
+static int arvoreMinimaGrupo(const ArmazemAntenas* antenas, const uint32_t* grupo, uint32_t m,
+                             int numThreads, ListaArestas* arvore) {
+    if (numThreads <= 0) numThreads = numeroThreads();
+    if ((uint32_t)numThreads > m) numThreads = (int)m;
+
+    // Cada divisão deixa pelo menos KD_FOLHA / 2 antenas em cada filho
+    size_t maxNos = 2 * ((size_t)m / (KD_FOLHA / 2) + 1);
+    ArvoreKd kd = { antenas, grupo, NULL, NULL, NULL, 1, NULL, NULL, NULL, NULL, m };
+    UniaoConjuntos u;
+    u.pai = reservarMemoria(MEM_OUTROS, m * sizeof(uint32_t));
+    u.ordem = reservarMemoriaZeros(MEM_OUTROS, m, sizeof(uint8_t));
+    u.numConjuntos = m;
+    kd.coordenadas = reservarMemoria(MEM_OUTROS, 2 * (size_t)m * sizeof(int));
+    kd.ordem = reservarMemoria(MEM_OUTROS, m * sizeof(uint32_t));
+    kd.nos = reservarMemoria(MEM_OUTROS, maxNos * sizeof(NoKd));
+    kd.componente = reservarMemoria(MEM_OUTROS, m * sizeof(uint32_t));
+    kd.melhorQ = reservarMemoria(MEM_OUTROS, m * sizeof(uint32_t));
+    kd.melhorD = reservarMemoria(MEM_OUTROS, m * sizeof(uint64_t));
+    kd.limite = reservarMemoria(MEM_OUTROS, m * sizeof(*kd.limite));
+    uint32_t* escolhida = reservarMemoria(MEM_OUTROS, m * sizeof(uint32_t));
+    int ok = u.pai && u.ordem && kd.coordenadas && kd.ordem && kd.nos && kd.componente && kd.melhorQ && kd.melhorD && kd.limite &&
+             escolhida;
+
+    size_t inicioArvore = arvore->num;
+    if (ok) {
+        for (uint32_t p = 0; p < m; p++) {
+            u.pai[p] = p;
+            kd.ordem[p] = p;
+            kd.coordenadas[2 * (size_t)p] = armazemX(antenas, grupo[p]);
+            kd.coordenadas[2 * (size_t)p + 1] = armazemY(antenas, grupo[p]);
+            kd.melhorQ[p] = UINT32_MAX;
+        }
+        construirNoKd(&kd, 0, 0, m);
+    }
+
+    while (ok && u.numConjuntos > 1) {
+        for (uint32_t p = 0; p < m; p++) {
+            kd.componente[p] = encontrar(&u, p);
+            escolhida[p] = UINT32_MAX;
+            atomic_init(&kd.limite[p], UINT64_MAX);
+        }
+        // As candidatas da ronda anterior que ainda ligam componentes diferentes dão um limite inicial
+        for (uint32_t p = 0; p < m; p++) {
+            uint32_t q = kd.melhorQ[p], r = kd.componente[p];
+            if (q != UINT32_MAX && kd.componente[q] != r && kd.melhorD[p] < atomic_load(&kd.limite[r])) {
+                atomic_store(&kd.limite[r], kd.melhorD[p]);
+            }
+        }
+        etiquetarNosKd(&kd);
+        executarParalelo(numThreads, procurarBlocoKd, &kd);
+
+        // Menor aresta de cada componente (guardada na raiz pela posição de origem)
+        for (uint32_t p = 0; p < m; p++) {
+            uint32_t r = kd.componente[p], e = escolhida[r];
+            if (kd.melhorQ[p] == UINT32_MAX) continue;
+            if (e == UINT32_MAX ||
+                antesKd(&kd, p, kd.melhorQ[p], kd.melhorD[p], e, kd.melhorQ[e], kd.melhorD[e])) {
+                escolhida[r] = p;
+            }
+        }
+
+        uint32_t antes = u.numConjuntos;
+        for (uint32_t r = 0; r < m && ok; r++) {
+            uint32_t p = escolhida[r];
+            if (p == UINT32_MAX) continue;
+            uint32_t q = kd.melhorQ[p];
+            if (unir(&u, p, q)) {
+                uint32_t i = grupo[p], j = grupo[q];
+                ok = acrescentarAresta(arvore, i < j ? i : j, i < j ? j : i, calcularDistancia(antenas, i, j));
+            }
+        }
+        if (u.numConjuntos == antes) break;
+    }
+
+    if (ok) {
+        ordenarParalelo(arvore->arestas + inicioArvore, arvore->num - inicioArvore, sizeof(ArestaMST),
+                        compararArestas, numThreads);
+    }
+
+    libertarMemoria(MEM_OUTROS, escolhida, m * sizeof(uint32_t));
+    libertarMemoria(MEM_OUTROS, kd.limite, m * sizeof(*kd.limite));
+    libertarMemoria(MEM_OUTROS, kd.melhorD, m * sizeof(uint64_t));
+    libertarMemoria(MEM_OUTROS, kd.melhorQ, m * sizeof(uint32_t));
+    libertarMemoria(MEM_OUTROS, kd.componente, m * sizeof(uint32_t));
+    libertarMemoria(MEM_OUTROS, kd.nos, maxNos * sizeof(NoKd));
+    libertarMemoria(MEM_OUTROS, kd.ordem, m * sizeof(uint32_t));
+    libertarMemoria(MEM_OUTROS, kd.coordenadas, 2 * (size_t)m * sizeof(int));
+    libertarMemoria(MEM_OUTROS, u.ordem, m * sizeof(uint8_t));
+    libertarMemoria(MEM_OUTROS, u.pai, m * sizeof(uint32_t));
+    return ok;
+}
+#pragma endregion
+
+#pragma region arvoreMinimaPorFrequencia
+/**
+ * @brief Calcula a árvore geradora mínima das antenas de cada frequência.
+ * @param antenas Armazém de antenas.
+ * @param frequencia Frequência a tratar, ou 0 para todas.
+ * @param numThreads Número de threads para a pesquisa e a ordenação.
+ * @param numArestas Ponteiro onde é guardado o número de arestas devolvidas.
+ * @return Vetor de arestas, ou NULL se não houver arestas ou em caso de erro.
+ */
+ArestaMST* arvoreMinimaPorFrequencia(const ArmazemAntenas* antenas, char frequencia, int numThreads,
+                                     uint32_t* numArestas) {
+    if (numArestas) *numArestas = 0;
+    if (!antenas || !numArestas) return NULL;
+
+    uint32_t inicio[257];
+    uint32_t* grupos = armazemAgruparPorFrequencia(antenas, inicio);
+    if (!grupos) return NULL;
+
+    // Cada grupo com m antenas contribui exatamente m - 1 arestas
+    size_t total = 0;
+    for (int f = 1; f < 256; f++) {
+        if (frequencia != 0 && f != (unsigned char)frequencia) continue;
+        uint32_t m = inicio[f + 1] - inicio[f];
+        if (m >= 2) total += m - 1;
+    }
+    ListaArestas arvore = { NULL, 0, total };
+    if (total) arvore.arestas = reservarMemoria(MEM_ARESTAS, total * sizeof(ArestaMST));
+    int ok = total == 0 || arvore.arestas;
+    for (int f = 1; f < 256 && ok; f++) {
+        if (frequencia != 0 && f != (unsigned char)frequencia) continue;
+        uint32_t m = inicio[f + 1] - inicio[f];
+        if (m < 2) continue;
+        ok = arvoreMinimaGrupo(antenas, &grupos[inicio[f]], m, numThreads, &arvore);
+    }
+
+    libertarGruposFrequencia(grupos, inicio);
+    if (ok && arvore.num < arvore.capacidade && arvore.num > 0) {
+        // Encolher para que libertarArvoreMinima possa usar o número de arestas devolvido
+        ArestaMST* justo = redimensionarMemoria(MEM_ARESTAS, arvore.arestas, arvore.capacidade * sizeof(ArestaMST),
+                                                arvore.num * sizeof(ArestaMST));
+        if (justo) {
+            arvore.arestas = justo;
+            arvore.capacidade = arvore.num;
+        } else {
+            ok = 0;
+        }
+    }
+    if (!ok || arvore.num == 0) {
+        libertarMemoria(MEM_ARESTAS, arvore.arestas, arvore.capacidade * sizeof(ArestaMST));
+        return NULL;
+    }
+    *numArestas = (uint32_t)arvore.num;
+    return arvore.arestas;
+}
+#pragma endregion
+
+#pragma region libertarArvoreMinima
+/**
+ * @brief Liberta o vetor de arestas devolvido por arvoreMinimaPorFrequencia.
+ * @param arestas Vetor de arestas (pode ser NULL).
+ * @param numArestas Número de arestas devolvido com o vetor.
+ */
+void libertarArvoreMinima(ArestaMST* arestas, uint32_t numArestas) {
+    libertarMemoria(MEM_ARESTAS, arestas, (size_t)numArestas * sizeof(ArestaMST));
+}
+#pragma endregion
@@ -0,0 +1,49 @@
+/**
+ * @author Tomás Cerqueira Gomes (a31501@alunos.ipca.pt)
+ * @date 2025-05-18
+ * 
+ * @file mst.h
+ * @brief Árvore geradora mínima de cada grupo de frequência.
+*/
+#ifndef MST_H
+#define MST_H
+
+#include <stdint.h>
+#include "../Fase1/antenas/antenas.h"
+
+/**
+ * @brief Aresta de uma árvore geradora mínima.
+ */
+typedef struct ArestaMST {
+    uint32_t a; //Índice da primeira antena no armazém
+    uint32_t b; //Índice da segunda antena no armazém
+    float distancia; //Distância entre as duas antenas
+} ArestaMST;
+
+/**
+ * @brief Calcula a árvore geradora mínima das antenas de cada frequência.
+ *
+ * Não é construído o grafo completo de cada frequência: cada grupo é organizado numa árvore k-d
+ * e o algoritmo de Borůvka junta as componentes ronda a ronda, procurando em paralelo a antena
+ * mais próxima noutra componente (os nós da árvore só com antenas da própria componente são
+ * ignorados). Cada ronda guarda uma candidata por antena, pelo que a memória é linear mesmo
+ * com antenas muito aglomeradas, e há no máximo log2(m) rondas.
+ * O resultado é uma árvore mínima exata de cada grupo (uma floresta, se houver várias frequências).
+ * @param antenas Armazém de antenas.
+ * @param frequencia Frequência a tratar, ou 0 para todas.
+ * @param numThreads Número de threads para a pesquisa e a ordenação (valores <= 0 usam todos os processadores).
+ * @param numArestas Ponteiro onde é guardado o número de arestas devolvidas.
+ * @return Vetor de arestas agrupadas por frequência e, em cada grupo, por distância crescente
+ *         (a libertar com libertarArvoreMinima), ou NULL se não houver arestas ou em caso de erro.
+ */
+ArestaMST* arvoreMinimaPorFrequencia(const ArmazemAntenas* antenas, char frequencia, int numThreads,
+                                     uint32_t* numArestas);
+
+/**
+ * @brief Liberta o vetor de arestas devolvido por arvoreMinimaPorFrequencia.
+ * @param arestas Vetor de arestas (pode ser NULL).
+ * @param numArestas Número de arestas devolvido com o vetor.
+ */
+void libertarArvoreMinima(ArestaMST* arestas, uint32_t numArestas);
+
+#endif
@@ -0,0 +1,207 @@
+/**
+ * @author Tomás Cerqueira Gomes (a31501@alunos.ipca.pt)
+ * @date 2025-05-18
+ * 
+ * @file paralelo.c
+ * @brief Implementação dos utilitários de execução em paralelo.
+*/
+
+#include "paralelo.h"
+#include "../Fase1/memoria/memoria.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#pragma region numeroThreads
+/**
+ * @brief Número de threads a usar por omissão (processadores disponíveis).
+ * @return Número de processadores, no mínimo 1.
+ */
+int numeroThreads(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+#pragma endregion
+
+#pragma region executarParalelo
+/**
+ * @brief Argumentos de arranque de cada thread.
+ */
+typedef struct ArranqueThread {
+    int id;
+    int numThreads;
+    TarefaParalela tarefa;
+    void* arg;
+    ErroMemoria erro; //Último erro de reserva da thread, lido depois de a tarefa terminar
+} ArranqueThread;
+
+/**
+ * @brief Ponto de entrada das threads criadas por executarParalelo.
+ */
+static void* arrancarThread(void* p) {
+    ArranqueThread* a = p;
+    a->tarefa(a->id, a->numThreads, a->arg);
+    a->erro = ultimoErroMemoria();
+    return NULL;
+}
+
+/**
+ * @brief Executa a tarefa em numThreads threads e espera que todas terminem.
+ *
+ * Se faltar memória para os vetores das threads, as tarefas correm todas na thread que chama;
+ * como o trabalho é feito na mesma, o erro de memória não fica registado.
+ * @param numThreads Número de threads (valores <= 0 usam numeroThreads()).
+ * @param tarefa Função a executar.
+ * @param arg Argumento passado a todas as threads.
+ */
+void executarParalelo(int numThreads, TarefaParalela tarefa, void* arg) {
+    if (numThreads <= 0) numThreads = numeroThreads();
+    if (numThreads == 1) {
+        tarefa(0, 1, arg);
+        return;
+    }
+
+    ErroMemoria anterior = ultimoErroMemoria();
+    pthread_t* threads = reservarMemoria(MEM_OUTROS, numThreads * sizeof(pthread_t));
+    ArranqueThread* args = reservarMemoria(MEM_OUTROS, numThreads * sizeof(ArranqueThread));
+    int* criada = reservarMemoriaZeros(MEM_OUTROS, numThreads, sizeof(int));
+    if (!threads || !args || !criada) {
+        libertarMemoria(MEM_OUTROS, threads, numThreads * sizeof(pthread_t));
+        libertarMemoria(MEM_OUTROS, args, numThreads * sizeof(ArranqueThread));
+        libertarMemoria(MEM_OUTROS, criada, numThreads * sizeof(int));
+        limparErroMemoria();
+        registarErroMemoria(anterior);
+        for (int i = 0; i < numThreads; i++) tarefa(i, numThreads, arg);
+        return;
+    }
+
+    for (int i = 1; i < numThreads; i++) {
+        args[i] = (ArranqueThread){ i, numThreads, tarefa, arg, MEMORIA_OK };
+        criada[i] = pthread_create(&threads[i], NULL, arrancarThread, &args[i]) == 0;
+    }
+    tarefa(0, numThreads, arg);
+    for (int i = 1; i < numThreads; i++) {
+        if (criada[i]) {
+            pthread_join(threads[i], NULL);
+            registarErroMemoria(args[i].erro);
+        } else {
+            tarefa(i, numThreads, arg);
+        }
+    }
+
+    libertarMemoria(MEM_OUTROS, threads, numThreads * sizeof(pthread_t));
+    libertarMemoria(MEM_OUTROS, args, numThreads * sizeof(ArranqueThread));
+    libertarMemoria(MEM_OUTROS, criada, numThreads * sizeof(int));
+}
+#pragma endregion
+
+#pragma region ordenarParalelo
+/**
+ * @brief Estado partilhado da ordenação em paralelo.
+ */
+typedef struct Ordenacao {
+    char* origem; //Vetor com os blocos a fundir
+    char* destino; //Vetor onde ficam os blocos fundidos
+    size_t n; //Número de elementos
+    size_t tamanho; //Tamanho de cada elemento
+    size_t* limites; //Limites dos blocos (numBlocos + 1 posições)
+    int numBlocos; //Número de blocos atual
+    int (*comparar)(const void*, const void*);
+} Ordenacao;
+
+/**
+ * @brief Ordena com qsort os blocos atribuídos a esta thread.
+ */
+static void ordenarBlocos(int id, int numThreads, void* arg) {
+    Ordenacao* o = arg;
+    for (int b = id; b < o->numBlocos; b += numThreads) {
+        qsort(o->origem + o->limites[b] * o->tamanho, o->limites[b + 1] - o->limites[b],
+              o->tamanho, o->comparar);
+    }
+}
+
+/**
+ * @brief Funde pares de blocos vizinhos (2b, 2b + 1) de origem para destino.
+ *
+ * Em caso de empate fica primeiro o elemento do bloco da esquerda.
+ */
+static void fundirBlocos(int id, int numThreads, void* arg) {
+    Ordenacao* o = arg;
+    size_t t = o->tamanho;
+    for (int b = 2 * id; b < o->numBlocos; b += 2 * numThreads) {
+        size_t i = o->limites[b];
+        size_t meio = o->limites[b + 1];
+        size_t fim = b + 1 < o->numBlocos ? o->limites[b + 2] : meio;
+        size_t j = meio, k = i;
+        while (i < meio && j < fim) {
+            if (o->comparar(o->origem + j * t, o->origem + i * t) < 0) {
+                memcpy(o->destino + k++ * t, o->origem + j++ * t, t);
+            } else {
+                memcpy(o->destino + k++ * t, o->origem + i++ * t, t);
+            }
+        }
+        memcpy(o->destino + k * t, o->origem + i * t, (meio - i) * t);
+        k += meio - i;
+        memcpy(o->destino + k * t, o->origem + j * t, (fim - j) * t);
+    }
+}
+
+/**
+ * @brief Ordena um vetor em paralelo (qsort por blocos seguido de fusões em paralelo).
+ * @param base Início do vetor.
+ * @param n Número de elementos.
+ * @param tamanho Tamanho de cada elemento em bytes.
+ * @param comparar Função de comparação (como em qsort).
+ * @param numThreads Número de threads (valores <= 0 usam numeroThreads()).
+ * @return 1 em caso de sucesso, 0 se faltar memória (o vetor fica ordenado em série).
+ */
+int ordenarParalelo(void* base, size_t n, size_t tamanho,
+                    int (*comparar)(const void*, const void*), int numThreads) {
+    if (numThreads <= 0) numThreads = numeroThreads();
+    // Vetores pequenos não compensam o custo das threads
+    if (numThreads == 1 || n < 4096) {
+        qsort(base, n, tamanho, comparar);
+        return 1;
+    }
+
+    Ordenacao o;
+    o.n = n;
+    o.tamanho = tamanho;
+    o.comparar = comparar;
+    o.numBlocos = numThreads;
+    o.origem = base;
+    o.destino = reservarMemoria(MEM_OUTROS, n * tamanho);
+    o.limites = reservarMemoria(MEM_OUTROS, (numThreads + 1) * sizeof(size_t));
+    if (!o.destino || !o.limites) {
+        libertarMemoria(MEM_OUTROS, o.destino, n * tamanho);
+        libertarMemoria(MEM_OUTROS, o.limites, (numThreads + 1) * sizeof(size_t));
+        qsort(base, n, tamanho, comparar);
+        return 0;
+    }
+    for (int b = 0; b <= numThreads; b++) o.limites[b] = n * b / numThreads;
+
+    executarParalelo(numThreads, ordenarBlocos, &o);
+
+    while (o.numBlocos > 1) {
+        executarParalelo(numThreads, fundirBlocos, &o);
+        // Os limites dos blocos fundidos são os limites pares
+        int novos = (o.numBlocos + 1) / 2;
+        for (int b = 0; b < novos; b++) o.limites[b] = o.limites[2 * b];
+        o.limites[novos] = n;
+        o.numBlocos = novos;
+        char* aux = o.origem;
+        o.origem = o.destino;
+        o.destino = aux;
+    }
+
+    if (o.origem != base) {
+        memcpy(base, o.origem, n * tamanho);
+        libertarMemoria(MEM_OUTROS, o.origem, n * tamanho);
+    } else {
+        libertarMemoria(MEM_OUTROS, o.destino, n * tamanho);
+    }
+    libertarMemoria(MEM_OUTROS, o.limites, (numThreads + 1) * sizeof(size_t));
+    return 1;
+}
+#pragma endregion
@@ -0,0 +1,54 @@
+/**
+ * @author Tomás Cerqueira Gomes (a31501@alunos.ipca.pt)
+ * @date 2025-05-18
+ * 
+ * @file paralelo.h
+ * @brief Utilitários de execução em paralelo (threads POSIX).
+*/
+#ifndef PARALELO_H
+#define PARALELO_H
+
+#include <stddef.h>
+
+/**
+ * @brief Função executada por cada thread.
+ * @param id Número da thread (0 a numThreads - 1).
+ * @param numThreads Número total de threads.
+ * @param arg Argumento partilhado por todas as threads.
+ */
+typedef void (*TarefaParalela)(int id, int numThreads, void* arg);
+
+/**
+ * @brief Número de threads a usar por omissão (processadores disponíveis).
+ * @return Número de processadores, no mínimo 1.
+ */
+int numeroThreads(void);
+
+/**
+ * @brief Executa a tarefa em numThreads threads e espera que todas terminem.
+ *
+ * A thread 0 é a própria thread que chama a função. Se não for possível criar
+ * uma thread, a sua parte do trabalho é feita pela thread que chama. Os erros de reserva
+ * das outras threads passam para a thread que chama (ver ultimoErroMemoria).
+ * @param numThreads Número de threads (valores <= 0 usam numeroThreads()).
+ * @param tarefa Função a executar.
+ * @param arg Argumento passado a todas as threads.
+ */
+void executarParalelo(int numThreads, TarefaParalela tarefa, void* arg);
+
+/**
+ * @brief Ordena um vetor em paralelo (qsort por blocos seguido de fusões em paralelo).
+ *
+ * A ordenação é estável entre blocos, pelo que o resultado só depende da função
+ * de comparação e não do número de threads quando a comparação é total.
+ * @param base Início do vetor.
+ * @param n Número de elementos.
+ * @param tamanho Tamanho de cada elemento em bytes.
+ * @param comparar Função de comparação (como em qsort).
+ * @param numThreads Número de threads (valores <= 0 usam numeroThreads()).
+ * @return 1 em caso de sucesso, 0 se faltar memória (o vetor fica ordenado em série).
+ */
+int ordenarParalelo(void* base, size_t n, size_t tamanho,
+                    int (*comparar)(const void*, const void*), int numThreads);
+
+#endif
@@ -0,0 +1,419 @@
+/**
+ * @author Tomás Cerqueira Gomes (a31501@alunos.ipca.pt)
+ * @date 2025-05-18
+ *
+ * @file pesquisa.c
+ * @brief Implementação da pesquisa em largura em paralelo com otimização de direção.
+*/
+
+#include "pesquisa.h"
+#include "paralelo.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ALFA 14 //Muda para baixo-para-cima quando as arestas da fronteira passam 1/ALFA das restantes
+#define BETA 24 //Volta a cima-para-baixo quando a fronteira tem menos de 1/BETA dos vértices
+#define TRABALHO_POR_THREAD 16384 //Trabalho mínimo (arestas ou vértices) que justifica mais uma thread
+#define TAMANHO_LINHA_CACHE 64
+
+#pragma region EstadoBFS
+/**
+ * @brief Vértices encontrados por uma thread num nível.
+ */
+typedef struct BufferThread {
+    uint32_t* itens; //Vértices encontrados (só no passo de cima para baixo)
+    uint32_t num; //Número de vértices em itens
+    uint32_t capacidade; //Capacidade de itens
+    uint32_t encontrados; //Vértices encontrados no nível
+    uint32_t posicao; //Posição da thread na nova fila
+    uint64_t arestas; //Soma dos graus dos vértices encontrados
+    char separador[TAMANHO_LINHA_CACHE]; //Evita que threads vizinhas partilhem a linha de cache
+} BufferThread;
+
+/**
+ * @brief Estado partilhado da pesquisa.
+ */
+typedef struct EstadoBFS {
+    const GrafoCSR* csr; //Vista do grafo
+    ResultadoBFS* resultado; //Distâncias e pais
+    _Atomic uint64_t* visitados; //Mapa de bits dos vértices visitados
+    _Atomic uint64_t* fronteira; //Mapa de bits da fronteira (passo de baixo para cima)
+    _Atomic uint64_t* proxima; //Mapa de bits da fronteira seguinte
+    uint32_t* fila; //Fronteira como lista (passo de cima para baixo)
+    uint32_t* proximaFila; //Fronteira seguinte como lista
+    uint32_t numFila; //Número de vértices em fila
+    uint32_t numPalavras; //Palavras de 64 bits de cada mapa
+    int32_t nivel; //Distância dos vértices da fronteira
+    BufferThread* buffers; //Um por thread
+    atomic_int erro; //1 se faltou memória
+} EstadoBFS;
+
+/**
+ * @brief Grau de um vértice na vista CSR.
+ */
+static inline uint32_t grauCSR(const GrafoCSR* csr, uint32_t v) {
+    return csr->inicio[v + 1] - csr->inicio[v];
+}
+
+/**
+ * @brief Número de threads para um passo com o trabalho indicado.
+ */
+static int threadsParaTrabalho(int numThreads, uint64_t trabalho) {
+    uint64_t maximo = 1 + trabalho / TRABALHO_POR_THREAD;
+    return (uint64_t)numThreads > maximo ? (int)maximo : numThreads;
+}
+
+/**
+ * @brief Palavras dos mapas de bits atribuídas a uma thread.
+ */
+static void palavrasDaThread(const EstadoBFS* e, int id, int numThreads, uint32_t* a, uint32_t* b) {
+    *a = (uint32_t)((uint64_t)e->numPalavras * id / numThreads);
+    *b = (uint32_t)((uint64_t)e->numPalavras * (id + 1) / numThreads);
+}
+
+/**
+ * @brief Bits válidos de uma palavra (a última pode ter bits para lá do último vértice).
+ */
+static inline uint64_t bitsValidos(const EstadoBFS* e, uint32_t w) {
+    uint32_t resto = e->csr->numVertices % 64;
+    return (w == e->numPalavras - 1 && resto) ? ((1ULL << resto) - 1) : ~0ULL;
+}
+#pragma endregion
+
+#pragma region passoDescendente
+/**
+ * @brief Guarda um vértice encontrado no buffer da thread.
+ * @return 1 em caso de sucesso, 0 se faltar memória.
+ */
+static int guardarEncontrado(BufferThread* b, uint32_t v) {
+    if (b->num == b->capacidade) {
+        uint32_t novaCap = b->capacidade ? b->capacidade * 2 : 1024;
+        uint32_t* novo = redimensionarMemoria(MEM_OUTROS, b->itens, (size_t)b->capacidade * sizeof(uint32_t),
+                                              (size_t)novaCap * sizeof(uint32_t));
+        if (!novo) return 0;
+        b->itens = novo;
+        b->capacidade = novaCap;
+    }
+    b->itens[b->num++] = v;
+    return 1;
+}
+
+/**
+ * @brief Passo de cima para baixo: a parte da fila desta thread marca os vizinhos por visitar.
+ *
+ * Um vizinho é reclamado com um "ou" atómico no mapa de visitados; só a thread que muda o bit
+ * escreve a distância e o pai e guarda o vértice no seu buffer.
+ */
+static void passoDescendente(int id, int numThreads, void* arg) {
+    EstadoBFS* e = arg;
+    const GrafoCSR* csr = e->csr;
+    BufferThread* b = &e->buffers[id];
+    b->num = b->encontrados = 0;
+    b->arestas = 0;
+
+    uint32_t k = (uint32_t)((uint64_t)e->numFila * id / numThreads);
+    uint32_t fim = (uint32_t)((uint64_t)e->numFila * (id + 1) / numThreads);
+    for (; k < fim; k++) {
+        uint32_t u = e->fila[k];
+        for (uint32_t a = csr->inicio[u]; a < csr->inicio[u + 1]; a++) {
+            uint32_t v = csr->destinos[a];
+            uint64_t bit = 1ULL << (v % 64);
+            if (atomic_load_explicit(&e->visitados[v / 64], memory_order_relaxed) & bit) continue;
+            if (atomic_fetch_or_explicit(&e->visitados[v / 64], bit, memory_order_relaxed) & bit) continue;
+            e->resultado->distancias[v] = e->nivel + 1;
+            e->resultado->pais[v] = u;
+            b->arestas += grauCSR(csr, v);
+            if (!guardarEncontrado(b, v)) {
+                atomic_store(&e->erro, 1);
+                return;
+            }
+        }
+    }
+    b->encontrados = b->num;
+}
+
+/**
+ * @brief Copia o buffer desta thread para a sua posição na fila seguinte.
+ */
+static void juntarBuffers(int id, int numThreads, void* arg) {
+    EstadoBFS* e = arg;
+    (void)numThreads;
+    BufferThread* b = &e->buffers[id];
+    if (b->num) memcpy(&e->proximaFila[b->posicao], b->itens, (size_t)b->num * sizeof(uint32_t));
+}
+#pragma endregion
+
+#pragma region passoAscendente
+/**
+ * @brief Passo de baixo para cima: cada vértice por visitar das palavras desta thread procura
+ *        um vizinho na fronteira e para no primeiro que encontrar.
+ *
+ * Cada palavra dos mapas pertence a uma só thread, pelo que a fronteira seguinte é escrita
+ * palavra a palavra, sem operações atómicas de leitura e escrita.
+ */
+static void passoAscendente(int id, int numThreads, void* arg) {
+    EstadoBFS* e = arg;
+    const GrafoCSR* csr = e->csr;
+    BufferThread* b = &e->buffers[id];
+    b->num = b->encontrados = 0;
+    b->arestas = 0;
+
+    uint32_t w, fim;
+    palavrasDaThread(e, id, numThreads, &w, &fim);
+    for (; w < fim; w++) {
+        uint64_t visitados = atomic_load_explicit(&e->visitados[w], memory_order_relaxed);
+        uint64_t livres = ~visitados & bitsValidos(e, w);
+        uint64_t novos = 0;
+        while (livres) {
+            int bit = __builtin_ctzll(livres);
+            livres &= livres - 1;
+            uint32_t v = w * 64 + (uint32_t)bit;
+            for (uint32_t a = csr->inicio[v]; a < csr->inicio[v + 1]; a++) {
+                uint32_t u = csr->destinos[a];
+                if (atomic_load_explicit(&e->fronteira[u / 64], memory_order_relaxed) & (1ULL << (u % 64))) {
+                    e->resultado->distancias[v] = e->nivel + 1;
+                    e->resultado->pais[v] = u;
+                    novos |= 1ULL << bit;
+                    b->encontrados++;
+                    b->arestas += grauCSR(csr, v);
+                    break;
+                }
+            }
+        }
+        atomic_store_explicit(&e->proxima[w], novos, memory_order_relaxed);
+        if (novos) atomic_store_explicit(&e->visitados[w], visitados | novos, memory_order_relaxed);
+    }
+}
+#pragma endregion
+
+#pragma region conversoesFronteira
+/**
+ * @brief Limpa as palavras desta thread no mapa da fronteira.
+ */
+static void limparFronteira(int id, int numThreads, void* arg) {
+    EstadoBFS* e = arg;
+    uint32_t w, fim;
+    palavrasDaThread(e, id, numThreads, &w, &fim);
+    for (; w < fim; w++) atomic_store_explicit(&e->fronteira[w], 0, memory_order_relaxed);
+}
+
+/**
+ * @brief Marca no mapa da fronteira a parte da fila desta thread.
+ */
+static void marcarFila(int id, int numThreads, void* arg) {
+    EstadoBFS* e = arg;
+    uint32_t k = (uint32_t)((uint64_t)e->numFila * id / numThreads);
+    uint32_t fim = (uint32_t)((uint64_t)e->numFila * (id + 1) / numThreads);
+    for (; k < fim; k++) {
+        uint32_t v = e->fila[k];
+        atomic_fetch_or_explicit(&e->fronteira[v / 64], 1ULL << (v % 64), memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Conta os bits da fronteira nas palavras desta thread.
+ */
+static void contarFronteira(int id, int numThreads, void* arg) {
+    EstadoBFS* e = arg;
+    uint32_t w, fim;
+    palavrasDaThread(e, id, numThreads, &w, &fim);
+    uint32_t n = 0;
+    for (; w < fim; w++) n += (uint32_t)__builtin_popcountll(atomic_load_explicit(&e->fronteira[w], memory_order_relaxed));
+    e->buffers[id].num = n;
+}
+
+/**
+ * @brief Escreve na fila, a partir da posição desta thread, os vértices das suas palavras da fronteira.
+ */
+static void escreverFronteira(int id, int numThreads, void* arg) {
+    EstadoBFS* e = arg;
+    uint32_t w, fim;
+    palavrasDaThread(e, id, numThreads, &w, &fim);
+    uint32_t k = e->buffers[id].posicao;
+    for (; w < fim; w++) {
+        uint64_t bits = atomic_load_explicit(&e->fronteira[w], memory_order_relaxed);
+        while (bits) {
+            e->fila[k++] = w * 64 + (uint32_t)__builtin_ctzll(bits);
+            bits &= bits - 1;
+        }
+    }
+}
+
+/**
+ * @brief Calcula a posição de cada thread a partir dos tamanhos em buffers[].num.
+ * @return Soma dos tamanhos.
+ */
+static uint32_t posicoesDosBuffers(EstadoBFS* e, int numThreads) {
+    uint32_t total = 0;
+    for (int t = 0; t < numThreads; t++) {
+        e->buffers[t].posicao = total;
+        total += e->buffers[t].num;
+    }
+    return total;
+}
+
+/**
+ * @brief Passa a fronteira da fila para o mapa de bits.
+ */
+static void filaParaMapa(EstadoBFS* e, int numThreads) {
+    executarParalelo(threadsParaTrabalho(numThreads, e->numPalavras), limparFronteira, e);
+    executarParalelo(threadsParaTrabalho(numThreads, e->numFila), marcarFila, e);
+}
+
+/**
+ * @brief Passa a fronteira do mapa de bits para a fila (por ordem crescente de índice).
+ */
+static void mapaParaFila(EstadoBFS* e, int numThreads) {
+    int t = threadsParaTrabalho(numThreads, e->numPalavras);
+    executarParalelo(t, contarFronteira, e);
+    e->numFila = posicoesDosBuffers(e, t);
+    executarParalelo(t, escreverFronteira, e);
+}
+#pragma endregion
+
+#pragma region bfsParalelo
+/**
+ * @brief Liberta os vetores temporários da pesquisa.
+ */
+static void libertarEstadoBFS(EstadoBFS* e, int numThreads) {
+    size_t palavras = e->numPalavras ? e->numPalavras : 1;
+    size_t tamanho = e->csr->numVertices ? e->csr->numVertices : 1;
+    libertarMemoria(MEM_OUTROS, (void*)e->visitados, palavras * sizeof(uint64_t));
+    libertarMemoria(MEM_OUTROS, (void*)e->fronteira, palavras * sizeof(uint64_t));
+    libertarMemoria(MEM_OUTROS, (void*)e->proxima, palavras * sizeof(uint64_t));
+    libertarMemoria(MEM_OUTROS, e->fila, tamanho * sizeof(uint32_t));
+    libertarMemoria(MEM_OUTROS, e->proximaFila, tamanho * sizeof(uint32_t));
+    if (e->buffers) {
+        for (int t = 0; t < numThreads; t++) {
+            libertarMemoria(MEM_OUTROS, e->buffers[t].itens, (size_t)e->buffers[t].capacidade * sizeof(uint32_t));
+        }
+    }
+    libertarMemoria(MEM_OUTROS, e->buffers, (size_t)numThreads * sizeof(BufferThread));
+}
+
+/**
+ * @brief Pesquisa em largura em paralelo, nível a nível, a partir de uma ou mais origens.
+ * @param csr Vista CSR do grafo.
+ * @param origens Índices de antena das origens.
+ * @param numOrigens Número de origens.
+ * @param numThreads Número de threads (valores <= 0 usam os processadores disponíveis).
+ * @param resultado Estrutura onde é devolvido o resultado.
+ * @return 1 em caso de sucesso, 0 em caso de erro.
+ */
+int bfsParalelo(const GrafoCSR* csr, const uint32_t* origens, uint32_t numOrigens, int numThreads,
+                ResultadoBFS* resultado) {
+    if (!resultado) return 0;
+    memset(resultado, 0, sizeof(ResultadoBFS));
+    if (!csr || (numOrigens > 0 && !origens)) return 0;
+    uint32_t n = csr->numVertices;
+    for (uint32_t i = 0; i < numOrigens; i++) {
+        if (origens[i] >= n) return 0;
+    }
+    if (numThreads <= 0) numThreads = numeroThreads();
+
+    size_t tamanho = n ? n : 1;
+    resultado->numVertices = n;
+    resultado->distancias = reservarMemoria(MEM_OUTROS, tamanho * sizeof(int32_t));
+    resultado->pais = reservarMemoria(MEM_OUTROS, tamanho * sizeof(uint32_t));
+
+    EstadoBFS e = { .csr = csr, .resultado = resultado, .numPalavras = (n + 63) / 64 };
+    size_t palavras = e.numPalavras ? e.numPalavras : 1;
+    atomic_init(&e.erro, 0);
+    e.visitados = reservarMemoriaZeros(MEM_OUTROS, palavras, sizeof(uint64_t));
+    e.fronteira = reservarMemoriaZeros(MEM_OUTROS, palavras, sizeof(uint64_t));
+    e.proxima = reservarMemoriaZeros(MEM_OUTROS, palavras, sizeof(uint64_t));
+    e.fila = reservarMemoria(MEM_OUTROS, tamanho * sizeof(uint32_t));
+    e.proximaFila = reservarMemoria(MEM_OUTROS, tamanho * sizeof(uint32_t));
+    e.buffers = reservarMemoriaZeros(MEM_OUTROS, numThreads, sizeof(BufferThread));
+    if (!resultado->distancias || !resultado->pais || !e.visitados || !e.fronteira || !e.proxima ||
+        !e.fila || !e.proximaFila || !e.buffers) {
+        libertarEstadoBFS(&e, numThreads);
+        libertarResultadoBFS(resultado);
+        return 0;
+    }
+    memset(resultado->distancias, 0xFF, tamanho * sizeof(int32_t)); // -1
+    memset(resultado->pais, 0xFF, tamanho * sizeof(uint32_t)); // BFS_SEM_PAI
+
+    // Nível 0: as origens
+    uint64_t arestasFronteira = 0;
+    for (uint32_t i = 0; i < numOrigens; i++) {
+        uint32_t s = origens[i];
+        uint64_t bit = 1ULL << (s % 64);
+        if (atomic_load_explicit(&e.visitados[s / 64], memory_order_relaxed) & bit) continue;
+        atomic_fetch_or_explicit(&e.visitados[s / 64], bit, memory_order_relaxed);
+        resultado->distancias[s] = 0;
+        resultado->pais[s] = s;
+        e.fila[e.numFila++] = s;
+        arestasFronteira += grauCSR(csr, s);
+    }
+    uint32_t tamanhoFronteira = e.numFila;
+    uint64_t arestasPorVisitar = csr->numArestas - arestasFronteira;
+    resultado->numAlcancados = tamanhoFronteira;
+
+    int ascendente = 0;
+    while (tamanhoFronteira > 0) {
+        if (!ascendente && arestasFronteira > arestasPorVisitar / ALFA) {
+            filaParaMapa(&e, numThreads);
+            ascendente = 1;
+        } else if (ascendente && tamanhoFronteira < n / BETA) {
+            mapaParaFila(&e, numThreads);
+            ascendente = 0;
+        }
+
+        int t;
+        if (ascendente) {
+            t = threadsParaTrabalho(numThreads, (uint64_t)n + arestasPorVisitar);
+            executarParalelo(t, passoAscendente, &e);
+            _Atomic uint64_t* troca = e.fronteira;
+            e.fronteira = e.proxima;
+            e.proxima = troca;
+            resultado->passosAscendentes++;
+        } else {
+            t = threadsParaTrabalho(numThreads, arestasFronteira);
+            executarParalelo(t, passoDescendente, &e);
+            if (atomic_load(&e.erro)) break;
+            e.numFila = posicoesDosBuffers(&e, t);
+            executarParalelo(t, juntarBuffers, &e);
+            uint32_t* troca = e.fila;
+            e.fila = e.proximaFila;
+            e.proximaFila = troca;
+            resultado->passosDescendentes++;
+        }
+
+        tamanhoFronteira = 0;
+        arestasFronteira = 0;
+        for (int i = 0; i < t; i++) {
+            tamanhoFronteira += e.buffers[i].encontrados;
+            arestasFronteira += e.buffers[i].arestas;
+        }
+        arestasPorVisitar -= arestasFronteira;
+        resultado->numAlcancados += tamanhoFronteira;
+        resultado->numNiveis++;
+        e.nivel++;
+    }
+
+    int erro = atomic_load(&e.erro);
+    libertarEstadoBFS(&e, numThreads);
+    if (erro) {
+        libertarResultadoBFS(resultado);
+        return 0;
+    }
+    return 1;
+}
+#pragma endregion
+
+#pragma region libertarResultadoBFS
+/**
+ * @brief Liberta os vetores de um resultado.
+ * @param resultado Resultado de bfsParalelo.
+ */
+void libertarResultadoBFS(ResultadoBFS* resultado) {
+    if (!resultado) return;
+    size_t tamanho = resultado->numVertices ? resultado->numVertices : 1;
+    libertarMemoria(MEM_OUTROS, resultado->distancias, tamanho * sizeof(int32_t));
+    libertarMemoria(MEM_OUTROS, resultado->pais, tamanho * sizeof(uint32_t));
+    resultado->distancias = NULL;
+    resultado->pais = NULL;
+}
+#pragma endregion
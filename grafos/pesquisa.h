@@ -0,0 +1,60 @@
+/**
+ * @author Tomás Cerqueira Gomes (a31501@alunos.ipca.pt)
+ * @date 2025-05-18
+ *
+ * @file pesquisa.h
+ * @brief Pesquisa em largura em paralelo sobre a vista CSR, com otimização de direção.
+*/
+#ifndef PESQUISA_H
+#define PESQUISA_H
+
+#include "grafos.h"
+
+#define BFS_SEM_PAI UINT32_MAX //Pai dos índices não alcançados
+
+/**
+ * @brief Resultado de uma pesquisa em largura.
+ */
+typedef struct ResultadoBFS {
+    uint32_t numVertices; //Número de índices cobertos (o da vista CSR)
+    int32_t* distancias; //Número de saltos até à origem mais próxima, ou -1 se não for alcançado
+    uint32_t* pais; //Índice anterior no caminho mais curto (a própria origem nas origens), ou BFS_SEM_PAI
+    uint32_t numAlcancados; //Número de índices alcançados (incluindo as origens)
+    uint32_t numNiveis; //Número de níveis percorridos (maior distância + 1)
+    uint32_t passosDescendentes; //Níveis feitos de cima para baixo (a partir da fronteira)
+    uint32_t passosAscendentes; //Níveis feitos de baixo para cima (a partir dos não visitados)
+} ResultadoBFS;
+
+/**
+ * @brief Pesquisa em largura em paralelo, nível a nível, a partir de uma ou mais origens.
+ *
+ * Cada nível é feito de cima para baixo (cada vértice da fronteira marca os vizinhos ainda
+ * não visitados, com um mapa de bits atómico) ou de baixo para cima (cada vértice não visitado
+ * procura um vizinho na fronteira e para no primeiro). A direção muda com o tamanho da
+ * fronteira, como na pesquisa com otimização de direção de Beamer: passa a ser de baixo para
+ * cima quando as arestas da fronteira ultrapassam 1/14 das arestas dos não visitados e volta
+ * a ser de cima para baixo quando a fronteira tem menos de 1/24 dos vértices. Nos grupos de
+ * frequência, que são subgrafos muito densos, isto evita percorrer quase todas as arestas.
+ *
+ * Com várias origens, a distância é a da origem mais próxima (por exemplo, a distância de
+ * cada antena à antena de um conjunto mais próxima, em saltos). As distâncias não dependem
+ * do número de threads; os pais formam sempre uma árvore de caminhos mais curtos, mas em
+ * caso de empate o pai escolhido pode variar entre execuções. A vista tem de ser simétrica,
+ * como as de construirCSR e construirCSRParalelo (todos os modos de ligação são simétricos).
+ * @param csr Vista CSR do grafo.
+ * @param origens Índices de antena das origens (índices repetidos são ignorados).
+ * @param numOrigens Número de origens.
+ * @param numThreads Número de threads (valores <= 0 usam os processadores disponíveis).
+ * @param resultado Estrutura onde é devolvido o resultado.
+ * @return 1 em caso de sucesso, 0 se alguma origem estiver fora da vista ou faltar memória.
+ */
+int bfsParalelo(const GrafoCSR* csr, const uint32_t* origens, uint32_t numOrigens, int numThreads,
+                ResultadoBFS* resultado);
+
+/**
+ * @brief Liberta os vetores de um resultado.
+ * @param resultado Resultado de bfsParalelo.
+ */
+void libertarResultadoBFS(ResultadoBFS* resultado);
+
+#endif
@@ -0,0 +1,803 @@
+/**
+ * @author Tomás Cerqueira Gomes (a31501@alunos.ipca.pt)
+ * @date 2025-05-18
+ *
+ * @file pipeline.c
+ * @brief Implementação da leitura do mapa em pipeline (leitor + trabalhadores por frequência).
+*/
+
+#include "pipeline.h"
+#include "paralelo.h"
+#include <errno.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+
+#define LINHAS_POR_BANDA 32 //Linhas lidas antes de enviar um lote a cada trabalhador
+#define TAMANHO_BLOCO 65536 //Bytes lidos do ficheiro de cada vez
+#define TAMANHO_LINHA_CACHE 64
+#define NUM_SEGMENTOS 32 //Segmentos de um VetorSegmentado (2^32 - 1 posições)
+
+#pragma region FilaSPSC
+/**
+ * @brief Antena lida, com o índice que lhe foi atribuído no armazém.
+ */
+typedef struct ItemLote {
+    uint32_t indice; //Índice da antena no armazém
+    int x; //Coordenada X
+    int y; //Coordenada Y
+    char frequencia; //Frequência da antena
+} ItemLote;
+
+/**
+ * @brief Lote de antenas de uma banda de linhas destinado a um trabalhador.
+ *
+ * O próprio lote é o nó da fila: o consumidor fica com o último lote retirado como sentinela.
+ */
+typedef struct Lote {
+    _Atomic(struct Lote*) prox; //Lote seguinte na fila
+    ItemLote* itens; //Antenas do lote
+    uint32_t num; //Número de antenas
+    uint32_t capacidade; //Capacidade do vetor de antenas
+    int largura; //Largura conhecida depois da banda
+    int altura; //Número de linhas lidas depois da banda
+    int fim; //1 no último lote
+} Lote;
+
+/**
+ * @brief Fila sem locks de um produtor e um consumidor (lista ligada de lotes, sem limite).
+ *
+ * Como a fila não enche, o leitor nunca espera pelos trabalhadores, o que também permite
+ * que um trabalhador sem thread própria corra depois do leitor (ver executarParalelo).
+ * O semáforo conta os lotes por retirar: um trabalhador sem lotes fica bloqueado nele
+ * em vez de ocupar o processador a consultar a fila.
+ */
+typedef struct FilaSPSC {
+    Lote* cabeca; //Último lote retirado (só o consumidor mexe)
+    char separador[TAMANHO_LINHA_CACHE]; //Evita que cabeca e cauda partilhem a linha de cache
+    Lote* cauda; //Último lote colocado (só o produtor mexe)
+    sem_t disponiveis; //Lotes colocados e ainda não retirados
+} FilaSPSC;
+
+/**
+ * @brief Cria um lote vazio.
+ * @return Ponteiro para o lote, ou NULL se faltar memória.
+ */
+static Lote* novoLote(void) {
+    Lote* lote = reservarMemoriaZeros(MEM_OUTROS, 1, sizeof(Lote));
+    if (lote) atomic_init(&lote->prox, NULL);
+    return lote;
+}
+
+/**
+ * @brief Liberta um lote e as suas antenas.
+ * @param lote Lote a libertar.
+ */
+static void libertarLote(Lote* lote) {
+    libertarMemoria(MEM_OUTROS, lote->itens, lote->capacidade * sizeof(ItemLote));
+    libertarMemoria(MEM_OUTROS, lote, sizeof(Lote));
+}
+
+/**
+ * @brief Acrescenta uma antena a um lote ainda não enviado.
+ * @param lote Lote em construção.
+ * @param item Antena a acrescentar.
+ * @return 1 em caso de sucesso, 0 se faltar memória.
+ */
+static int acrescentarItem(Lote* lote, ItemLote item) {
+    if (lote->num == lote->capacidade) {
+        uint32_t novaCap = lote->capacidade ? lote->capacidade * 2 : 64;
+        ItemLote* novos = redimensionarMemoria(MEM_OUTROS, lote->itens, lote->capacidade * sizeof(ItemLote),
+                                               novaCap * sizeof(ItemLote));
+        if (!novos) return 0;
+        lote->itens = novos;
+        lote->capacidade = novaCap;
+    }
+    lote->itens[lote->num++] = item;
+    return 1;
+}
+
+/**
+ * @brief Inicia a fila com um lote sentinela.
+ * @param fila Fila a iniciar.
+ * @return 1 em caso de sucesso, 0 se faltar memória ou o semáforo não puder ser criado.
+ */
+static int iniciarFila(FilaSPSC* fila) {
+    fila->cabeca = fila->cauda = novoLote();
+    if (!fila->cabeca) return 0;
+    if (sem_init(&fila->disponiveis, 0, 0) != 0) {
+        libertarLote(fila->cabeca);
+        fila->cabeca = fila->cauda = NULL;
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Coloca um lote na fila (só o produtor).
+ * @param fila Fila de destino.
+ * @param lote Lote a colocar (deixa de pertencer ao produtor).
+ */
+static void colocarNaFila(FilaSPSC* fila, Lote* lote) {
+    atomic_store_explicit(&fila->cauda->prox, lote, memory_order_release);
+    fila->cauda = lote;
+    sem_post(&fila->disponiveis);
+}
+
+/**
+ * @brief Retira o próximo lote da fila (só o consumidor), esperando que exista um.
+ *
+ * O lote devolvido passa a ser a sentinela e é libertado no retiro seguinte.
+ * @param fila Fila de origem.
+ * @return Próximo lote, ou NULL se a espera falhar.
+ */
+static Lote* retirarDaFila(FilaSPSC* fila) {
+    while (sem_wait(&fila->disponiveis) != 0) {
+        if (errno != EINTR) return NULL;
+    }
+    Lote* prox = atomic_load_explicit(&fila->cabeca->prox, memory_order_acquire);
+    if (!prox) return NULL;
+    libertarLote(fila->cabeca);
+    fila->cabeca = prox;
+    return prox;
+}
+
+/**
+ * @brief Liberta todos os lotes que ainda estão na fila (depois de as threads terminarem).
+ * @param fila Fila a libertar.
+ */
+static void libertarFila(FilaSPSC* fila) {
+    Lote* lote = fila->cabeca;
+    while (lote) {
+        Lote* prox = atomic_load_explicit(&lote->prox, memory_order_relaxed);
+        libertarLote(lote);
+        lote = prox;
+    }
+    sem_destroy(&fila->disponiveis);
+    fila->cabeca = fila->cauda = NULL;
+}
+#pragma endregion
+
+#pragma region GrelhaEfeitos
+/**
+ * @brief Vetor de ponteiros que cresce sem mudar de sítio.
+ *
+ * O segmento k tem 2^k posições e só é reservado quando é usado pela primeira vez;
+ * a posição i fica no segmento floor(log2(i + 1)). Segmentos e entradas são instalados
+ * com compare-and-swap, pelo que várias threads podem usar o vetor ao mesmo tempo.
+ */
+typedef struct VetorSegmentado {
+    _Atomic(_Atomic(void*)*) segmentos[NUM_SEGMENTOS];
+} VetorSegmentado;
+
+/**
+ * @brief Bloco de 32 linhas por 64 colunas da grelha de efeitos (um bit por posição).
+ */
+typedef struct BlocoEfeitos {
+    _Atomic uint64_t linhas[LINHAS_POR_BANDA];
+} BlocoEfeitos;
+
+/**
+ * @brief Banda de 32 linhas da grelha de efeitos (blocos de 64 colunas).
+ */
+typedef struct BandaEfeitos {
+    VetorSegmentado blocos;
+} BandaEfeitos;
+
+/**
+ * @brief Grelha de bits das posições com efeito, partilhada por todos os trabalhadores.
+ *
+ * Só são reservados os blocos onde passa alguma reta, pelo que a memória não depende do
+ * número de trabalhadores nem do tamanho do mapa, mas apenas das zonas com efeitos.
+ */
+typedef struct GrelhaEfeitos {
+    VetorSegmentado bandas;
+} GrelhaEfeitos;
+
+/**
+ * @brief Obtém (ou cria) uma entrada de um vetor segmentado.
+ * @param v Vetor.
+ * @param i Posição da entrada.
+ * @param tamanho Bytes da entrada (reservada a zeros).
+ * @param criar 1 para reservar a entrada se ainda não existir.
+ * @return Ponteiro para a entrada, ou NULL se não existir (ou faltar memória).
+ */
+static void* entradaVetor(VetorSegmentado* v, uint32_t i, size_t tamanho, int criar) {
+    int k = 31 - __builtin_clz(i + 1);
+    _Atomic(void*)* segmento = atomic_load_explicit(&v->segmentos[k], memory_order_acquire);
+    if (!segmento) {
+        if (!criar) return NULL;
+        _Atomic(void*)* novo = reservarMemoriaZeros(MEM_EFEITOS, (size_t)1 << k, sizeof(_Atomic(void*)));
+        if (!novo) return NULL;
+        segmento = NULL;
+        if (atomic_compare_exchange_strong_explicit(&v->segmentos[k], &segmento, novo,
+                                                    memory_order_acq_rel, memory_order_acquire)) {
+            segmento = novo;
+        } else {
+            libertarMemoria(MEM_EFEITOS, novo, ((size_t)1 << k) * sizeof(_Atomic(void*)));
+        }
+    }
+
+    _Atomic(void*)* posicao = &segmento[i + 1 - ((uint32_t)1 << k)];
+    void* entrada = atomic_load_explicit(posicao, memory_order_acquire);
+    if (entrada || !criar) return entrada;
+    void* nova = reservarMemoriaZeros(MEM_EFEITOS, 1, tamanho);
+    if (!nova) return NULL;
+    if (atomic_compare_exchange_strong_explicit(posicao, &entrada, nova,
+                                                memory_order_acq_rel, memory_order_acquire)) {
+        return nova;
+    }
+    libertarMemoria(MEM_EFEITOS, nova, tamanho);
+    return entrada;
+}
+
+/**
+ * @brief Liberta as entradas e os segmentos de um vetor segmentado (sem threads a usá-lo).
+ * @param v Vetor.
+ * @param tamanho Bytes de cada entrada.
+ * @param libertarConteudo Função chamada antes de libertar cada entrada (ou NULL).
+ */
+static void libertarVetor(VetorSegmentado* v, size_t tamanho, void (*libertarConteudo)(void*)) {
+    for (int k = 0; k < NUM_SEGMENTOS; k++) {
+        _Atomic(void*)* segmento = atomic_load_explicit(&v->segmentos[k], memory_order_relaxed);
+        if (!segmento) continue;
+        for (size_t j = 0; j < (size_t)1 << k; j++) {
+            void* entrada = atomic_load_explicit(&segmento[j], memory_order_relaxed);
+            if (!entrada) continue;
+            if (libertarConteudo) libertarConteudo(entrada);
+            libertarMemoria(MEM_EFEITOS, entrada, tamanho);
+        }
+        libertarMemoria(MEM_EFEITOS, segmento, ((size_t)1 << k) * sizeof(_Atomic(void*)));
+        atomic_store_explicit(&v->segmentos[k], NULL, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Liberta os blocos de uma banda.
+ */
+static void libertarBanda(void* banda) {
+    libertarVetor(&((BandaEfeitos*)banda)->blocos, sizeof(BlocoEfeitos), NULL);
+}
+
+/**
+ * @brief Marca a posição (x, y) na grelha, reservando a banda e o bloco se for preciso.
+ * @return 1 em caso de sucesso, 0 se faltar memória.
+ */
+static int marcarGrelha(GrelhaEfeitos* g, int x, int y) {
+    BandaEfeitos* banda = entradaVetor(&g->bandas, (uint32_t)y / LINHAS_POR_BANDA, sizeof(BandaEfeitos), 1);
+    BlocoEfeitos* bloco = banda ? entradaVetor(&banda->blocos, (uint32_t)x >> 6, sizeof(BlocoEfeitos), 1) : NULL;
+    if (!bloco) return 0;
+    atomic_fetch_or_explicit(&bloco->linhas[y % LINHAS_POR_BANDA], (uint64_t)1 << (x & 63), memory_order_relaxed);
+    return 1;
+}
+
+/**
+ * @brief Lê a palavra de 64 colunas p da linha y (0 se o bloco não existir).
+ */
+static uint64_t lerGrelha(GrelhaEfeitos* g, size_t p, int y) {
+    BandaEfeitos* banda = entradaVetor(&g->bandas, (uint32_t)y / LINHAS_POR_BANDA, sizeof(BandaEfeitos), 0);
+    BlocoEfeitos* bloco = banda ? entradaVetor(&banda->blocos, (uint32_t)p, sizeof(BlocoEfeitos), 0) : NULL;
+    return bloco ? atomic_load_explicit(&bloco->linhas[y % LINHAS_POR_BANDA], memory_order_relaxed) : 0;
+}
+
+/**
+ * @brief Liberta todos os blocos da grelha.
+ */
+static void libertarGrelhaEfeitos(GrelhaEfeitos* g) {
+    libertarVetor(&g->bandas, sizeof(BandaEfeitos), libertarBanda);
+}
+#pragma endregion
+
+#pragma region Trabalhador
+/**
+ * @brief Resto de uma reta que saiu da parte do mapa já lida.
+ */
+typedef struct Caminho {
+    int x; //Próxima posição X
+    int y; //Próxima posição Y
+    int dx; //Passo em X
+    int dy; //Passo em Y
+    int32_t prox; //Próximo caminho na mesma lista (-1 no fim)
+} Caminho;
+
+/**
+ * @brief Antena já vista de uma frequência.
+ */
+typedef struct MembroGrupo {
+    Vertice* v; //Vértice da antena
+    int x; //Coordenada X
+    int y; //Coordenada Y
+} MembroGrupo;
+
+/**
+ * @brief Antenas já vistas de uma frequência.
+ */
+typedef struct Grupo {
+    MembroGrupo* membros;
+    uint32_t num;
+    uint32_t capacidade;
+} Grupo;
+
+/**
+ * @brief Estado de um trabalhador (dono das frequências f com f % numTrabalhadores == id).
+ */
+typedef struct Trabalhador {
+    FilaSPSC fila; //Lotes enviados pelo leitor
+    Grupo grupos[256]; //Antenas já vistas de cada frequência
+    Vertice* vertices; //Vértices criados (ligados por proximo)
+    GrelhaEfeitos* grelha; //Grelha partilhada das posições com efeito
+    int largura; //Largura conhecida
+    int altura; //Linhas já lidas
+    Caminho* caminhos; //Caminhos pendentes (e livres)
+    int32_t numCaminhos; //Posições usadas em caminhos
+    int32_t capCaminhos; //Capacidade de caminhos
+    int32_t livres; //Lista de posições livres em caminhos
+    int32_t* baldes; //Caminhos parados em cada linha ainda não lida
+    int capBaldes; //Capacidade de baldes
+    int32_t pendentesX; //Caminhos parados à direita da largura conhecida
+    int erro; //1 se faltou memória
+} Trabalhador;
+
+/**
+ * @brief Reserva uma posição para um caminho pendente.
+ * @return Índice da posição, ou -1 se faltar memória.
+ */
+static int32_t novoCaminho(Trabalhador* t) {
+    if (t->livres >= 0) {
+        int32_t id = t->livres;
+        t->livres = t->caminhos[id].prox;
+        return id;
+    }
+    if (t->numCaminhos == t->capCaminhos) {
+        int32_t novaCap = t->capCaminhos ? t->capCaminhos * 2 : 256;
+        Caminho* novos = redimensionarMemoria(MEM_OUTROS, t->caminhos, (size_t)t->capCaminhos * sizeof(Caminho),
+                                              (size_t)novaCap * sizeof(Caminho));
+        if (!novos) return -1;
+        t->caminhos = novos;
+        t->capCaminhos = novaCap;
+    }
+    return t->numCaminhos++;
+}
+
+/**
+ * @brief Garante que existe o balde da linha y.
+ * @return 1 em caso de sucesso, 0 se faltar memória.
+ */
+static int garantirBalde(Trabalhador* t, int y) {
+    if (y < t->capBaldes) return 1;
+    int novaCap = t->capBaldes ? t->capBaldes * 2 : LINHAS_POR_BANDA;
+    while (novaCap <= y) novaCap *= 2;
+    int32_t* novos = redimensionarMemoria(MEM_OUTROS, t->baldes, (size_t)t->capBaldes * sizeof(int32_t),
+                                          (size_t)novaCap * sizeof(int32_t));
+    if (!novos) return 0;
+    for (int i = t->capBaldes; i < novaCap; i++) novos[i] = -1;
+    t->baldes = novos;
+    t->capBaldes = novaCap;
+    return 1;
+}
+
+/**
+ * @brief Percorre uma reta dentro da parte já lida do mapa, marcando cada posição.
+ *
+ * Se a reta sair pela direita ou por baixo, o resto fica pendente: à direita numa lista
+ * revista quando a largura aumentar, por baixo no balde da linha onde continua.
+ * @param t Trabalhador.
+ * @param id Posição do caminho, ou -1 se ainda não tiver uma.
+ * @param x Coordenada X inicial.
+ * @param y Coordenada Y inicial.
+ * @param dx Passo em X.
+ * @param dy Passo em Y.
+ */
+static void seguirCaminho(Trabalhador* t, int32_t id, int x, int y, int dx, int dy) {
+    while (x >= 0 && x < t->largura && y >= 0 && y < t->altura) {
+        if (!marcarGrelha(t->grelha, x, y)) {
+            t->erro = 1;
+            return;
+        }
+        x += dx;
+        y += dy;
+    }
+
+    // Saiu por cima ou pela esquerda: a reta acabou
+    if (x < 0 || y < 0) {
+        if (id >= 0) {
+            t->caminhos[id].prox = t->livres;
+            t->livres = id;
+        }
+        return;
+    }
+
+    if (id < 0 && (id = novoCaminho(t)) < 0) {
+        t->erro = 1;
+        return;
+    }
+    Caminho* c = &t->caminhos[id];
+    c->x = x;
+    c->y = y;
+    c->dx = dx;
+    c->dy = dy;
+    if (x >= t->largura) {
+        c->prox = t->pendentesX;
+        t->pendentesX = id;
+    } else if (garantirBalde(t, y)) {
+        c->prox = t->baldes[y];
+        t->baldes[y] = id;
+    } else {
+        t->erro = 1;
+    }
+}
+
+/**
+ * @brief Retoma todos os caminhos de uma lista.
+ * @param t Trabalhador.
+ * @param lista Primeiro caminho da lista (já retirada do sítio onde estava).
+ */
+static void retomarCaminhos(Trabalhador* t, int32_t lista) {
+    while (lista >= 0) {
+        Caminho c = t->caminhos[lista];
+        seguirCaminho(t, lista, c.x, c.y, c.dx, c.dy);
+        lista = c.prox;
+    }
+}
+
+/**
+ * @brief Alarga a parte conhecida do mapa e faz avançar os caminhos que ficaram à espera.
+ * @return 1 em caso de sucesso, 0 se faltar memória.
+ */
+static int atualizarLimites(Trabalhador* t, int largura, int altura) {
+    if (largura > t->largura) {
+        t->largura = largura;
+        int32_t lista = t->pendentesX;
+        t->pendentesX = -1;
+        retomarCaminhos(t, lista);
+    }
+    if (altura > t->altura) {
+        int antiga = t->altura;
+        t->altura = altura;
+        for (int y = antiga; y < altura && y < t->capBaldes; y++) {
+            int32_t lista = t->baldes[y];
+            t->baldes[y] = -1;
+            retomarCaminhos(t, lista);
+        }
+    }
+    return !t->erro;
+}
+
+/**
+ * @brief Liga dois vértices com uma aresta dirigida.
+ * @return 1 em caso de sucesso, 0 se faltar memória.
+ */
+static int ligarVertices(Vertice* origem, Vertice* destino, float distancia) {
+    Aresta* nova = reservarMemoria(MEM_ARESTAS, sizeof(Aresta));
+    if (!nova) return 0;
+    nova->distancia = distancia;
+    nova->destino = destino;
+    nova->prox = origem->adj;
+    origem->adj = nova;
+    return 1;
+}
+
+/**
+ * @brief Junta uma nova antena às antenas já vistas da sua frequência.
+ *
+ * Cria o vértice, as arestas para cada antena do grupo e percorre a reta de cada novo par.
+ * @param t Trabalhador dono da frequência.
+ * @param item Antena lida.
+ * @return 1 em caso de sucesso, 0 se faltar memória.
+ */
+static int juntarAntena(Trabalhador* t, const ItemLote* item) {
+    Vertice* v = inserirVertice(NULL, item->indice);
+    if (!v) return 0;
+    v->proximo = t->vertices;
+    t->vertices = v;
+
+    Grupo* g = &t->grupos[(unsigned char)item->frequencia];
+    for (uint32_t i = 0; i < g->num; i++) {
+        MembroGrupo* m = &g->membros[i];
+        float distancia = distanciaPontos(item->x, item->y, m->x, m->y);
+        if (!ligarVertices(v, m->v, distancia) || !ligarVertices(m->v, v, distancia)) return 0;
+
+        int dx, dy;
+        if (!passoReta(item->x, item->y, m->x, m->y, &dx, &dy)) continue; // Antenas na mesma posição
+        seguirCaminho(t, -1, item->x, item->y, dx, dy);
+        seguirCaminho(t, -1, item->x - dx, item->y - dy, -dx, -dy);
+        if (t->erro) return 0;
+    }
+
+    if (g->num == g->capacidade) {
+        uint32_t novaCap = g->capacidade ? g->capacidade * 2 : 16;
+        MembroGrupo* novos = redimensionarMemoria(MEM_OUTROS, g->membros, g->capacidade * sizeof(MembroGrupo),
+                                                  novaCap * sizeof(MembroGrupo));
+        if (!novos) return 0;
+        g->membros = novos;
+        g->capacidade = novaCap;
+    }
+    g->membros[g->num++] = (MembroGrupo){ v, item->x, item->y };
+    return 1;
+}
+
+/**
+ * @brief Consome os lotes da fila até ao último.
+ *
+ * Depois de um erro os lotes continuam a ser retirados (e libertados) até ao fim.
+ * @param t Trabalhador.
+ */
+static void trabalhar(Trabalhador* t) {
+    for (;;) {
+        Lote* lote = retirarDaFila(&t->fila);
+        if (!lote) { // A espera falhou: não há como saber quando chega o último lote
+            t->erro = 1;
+            return;
+        }
+        if (!t->erro && !atualizarLimites(t, lote->largura, lote->altura)) t->erro = 1;
+        for (uint32_t i = 0; i < lote->num && !t->erro; i++) {
+            if (!juntarAntena(t, &lote->itens[i])) t->erro = 1;
+        }
+        libertarMemoria(MEM_OUTROS, lote->itens, lote->capacidade * sizeof(ItemLote));
+        lote->itens = NULL;
+        lote->capacidade = 0;
+        if (lote->fim) return;
+    }
+}
+
+/**
+ * @brief Liberta uma lista de vértices (ligada por proximo) e as suas arestas.
+ * @param lista Primeiro vértice.
+ */
+static void libertarVertices(Vertice* lista) {
+    while (lista) {
+        Aresta* a = lista->adj;
+        while (a) {
+            Aresta* temp = a;
+            a = a->prox;
+            libertarMemoria(MEM_ARESTAS, temp, sizeof(Aresta));
+        }
+        Vertice* temp = lista;
+        lista = lista->proximo;
+        libertarMemoria(MEM_VERTICES, temp, sizeof(Vertice));
+    }
+}
+
+/**
+ * @brief Liberta o estado de um trabalhador (incluindo os vértices que ainda lhe pertencem).
+ * @param t Trabalhador.
+ */
+static void libertarTrabalhador(Trabalhador* t) {
+    libertarVertices(t->vertices);
+    for (int f = 0; f < 256; f++) {
+        libertarMemoria(MEM_OUTROS, t->grupos[f].membros, t->grupos[f].capacidade * sizeof(MembroGrupo));
+    }
+    libertarMemoria(MEM_OUTROS, t->caminhos, (size_t)t->capCaminhos * sizeof(Caminho));
+    libertarMemoria(MEM_OUTROS, t->baldes, (size_t)t->capBaldes * sizeof(int32_t));
+    if (t->fila.cabeca) libertarFila(&t->fila);
+}
+#pragma endregion
+
+#pragma region Leitor
+/**
+ * @brief Estado partilhado pelo leitor e pelos trabalhadores.
+ */
+typedef struct ContextoPipeline {
+    FILE* ficheiro; //Ficheiro de entrada
+    ArmazemAntenas* antenas; //Armazém preenchido pelo leitor
+    Trabalhador* trabalhadores; //Estado de cada trabalhador
+    Lote** lotes; //Lote em construção para cada trabalhador
+    GrelhaEfeitos grelha; //Posições com efeito marcadas pelos trabalhadores
+    int numTrabalhadores; //Número de trabalhadores
+    int largura; //Largura final do mapa
+    int altura; //Altura final do mapa
+    int erro; //1 se o leitor ficou sem memória
+} ContextoPipeline;
+
+/**
+ * @brief Envia o lote em construção a cada trabalhador.
+ *
+ * O lote seguinte é criado antes de o atual ser enviado; se faltar memória o atual fica
+ * por enviar, pelo que o último lote (fim = 1) pode sempre ser enviado.
+ * @param ctx Contexto da leitura.
+ * @param largura Largura conhecida.
+ * @param altura Número de linhas lidas.
+ * @param fim 1 se for o último lote.
+ */
+static void enviarBanda(ContextoPipeline* ctx, int largura, int altura, int fim) {
+    for (int w = 0; w < ctx->numTrabalhadores; w++) {
+        Lote* seguinte = NULL;
+        if (!fim && !(seguinte = novoLote())) {
+            ctx->erro = 1;
+            return;
+        }
+        Lote* lote = ctx->lotes[w];
+        lote->largura = largura;
+        lote->altura = altura;
+        lote->fim = fim;
+        colocarNaFila(&ctx->trabalhadores[w].fila, lote);
+        ctx->lotes[w] = seguinte;
+    }
+}
+
+/**
+ * @brief Lê o ficheiro por blocos e envia as antenas de cada banda de linhas.
+ *
+ * As regras são as de carregarAntenasDeFicheiro (letras são antenas) e as dimensões
+ * as de obterDimensoesMapa. O último lote é sempre enviado, mesmo em caso de erro.
+ * @param ctx Contexto da leitura.
+ */
+static void lerFicheiro(ContextoPipeline* ctx) {
+    char* bloco = reservarMemoria(MEM_OUTROS, TAMANHO_BLOCO);
+    int x = 0, y = 0, largura = 0;
+    size_t n;
+
+    if (!bloco) ctx->erro = 1;
+    while (!ctx->erro && (n = fread(bloco, 1, TAMANHO_BLOCO, ctx->ficheiro)) > 0) {
+        for (size_t i = 0; i < n && !ctx->erro; i++) {
+            char c = bloco[i];
+            if (c == '\n') {
+                if (x > largura) largura = x;
+                x = 0;
+                y++;
+                if (y % LINHAS_POR_BANDA == 0) enviarBanda(ctx, largura, y, 0);
+            } else if (c != '\r') {
+                if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z')) {
+                    ItemLote item = { 0, x, y, c };
+                    if (!armazemAdicionar(ctx->antenas, c, x, y, &item.indice) ||
+                        !acrescentarItem(ctx->lotes[(unsigned char)c % ctx->numTrabalhadores], item)) {
+                        ctx->erro = 1;
+                    }
+                }
+                x++;
+            }
+        }
+    }
+    if (x > 0) { // Última linha sem '\n'
+        if (x > largura) largura = x;
+        y++;
+    }
+    libertarMemoria(MEM_OUTROS, bloco, TAMANHO_BLOCO);
+
+    ctx->largura = largura;
+    ctx->altura = y;
+    enviarBanda(ctx, largura, y, 1);
+}
+
+/**
+ * @brief Tarefa de cada thread: a thread 0 lê, as restantes são trabalhadores.
+ */
+static void tarefaPipeline(int id, int numThreads, void* arg) {
+    ContextoPipeline* ctx = arg;
+    (void)numThreads;
+    if (id == 0) lerFicheiro(ctx);
+    else trabalhar(&ctx->trabalhadores[id - 1]);
+}
+#pragma endregion
+
+#pragma region carregarEmPipeline
+/**
+ * @brief Junta a grelha de efeitos e os vértices dos trabalhadores no resultado.
+ *
+ * A lista de efeitos fica ordenada por linhas e, em cada linha, por coluna.
+ * @param ctx Contexto depois de todas as threads terminarem.
+ * @param resultado Estrutura onde é guardado o resultado.
+ * @return 1 em caso de sucesso, 0 se faltar memória.
+ */
+static int juntarResultados(ContextoPipeline* ctx, ResultadoPipeline* resultado) {
+    size_t palavras = ((size_t)ctx->largura + 63) / 64;
+    Efeito* efeitos = NULL;
+    for (int y = ctx->altura - 1; y >= 0; y--) {
+        for (size_t p = palavras; p-- > 0;) {
+            uint64_t bits = lerGrelha(&ctx->grelha, p, y);
+            for (int b = 63; b >= 0; b--) {
+                if (!(bits >> b & 1)) continue;
+                Efeito* novo = reservarMemoria(MEM_EFEITOS, sizeof(Efeito));
+                if (!novo) {
+                    limparEfeitos(efeitos);
+                    return 0;
+                }
+                novo->x = (int)(p * 64) + b;
+                novo->y = y;
+                novo->prox = efeitos;
+                efeitos = novo;
+            }
+        }
+    }
+
+    uint32_t total = ctx->antenas->total;
+    size_t tamPorIndice = (total ? total : 1) * sizeof(Vertice*);
+    Vertice** porIndice = reservarMemoriaZeros(MEM_OUTROS, total ? total : 1, sizeof(Vertice*));
+    if (!porIndice) {
+        limparEfeitos(efeitos);
+        return 0;
+    }
+    for (int w = 0; w < ctx->numTrabalhadores; w++) {
+        for (Vertice* v = ctx->trabalhadores[w].vertices; v; v = v->proximo) porIndice[v->antena] = v;
+    }
+    GR* grafo = criarGrafoComVertices(ctx->antenas, porIndice);
+    if (!grafo) {
+        // A construção pode ter religado parte dos vértices por proximo: são libertados pelo índice
+        for (uint32_t i = 0; i < total; i++) {
+            if (!porIndice[i]) continue;
+            porIndice[i]->proximo = NULL;
+            libertarVertices(porIndice[i]);
+        }
+    }
+    libertarMemoria(MEM_OUTROS, porIndice, tamPorIndice);
+    for (int w = 0; w < ctx->numTrabalhadores; w++) ctx->trabalhadores[w].vertices = NULL;
+    if (!grafo) {
+        limparEfeitos(efeitos);
+        return 0;
+    }
+    ctx->antenas = NULL;
+
+    resultado->grafo = grafo;
+    resultado->efeitos = efeitos;
+    resultado->largura = ctx->largura;
+    resultado->altura = ctx->altura;
+    return 1;
+}
+
+/**
+ * @brief Lê o mapa e calcula os efeitos harmónicos e o grafo à medida que o ficheiro é lido.
+ * @param ficheiro Nome do ficheiro de entrada.
+ * @param numTrabalhadores Número de trabalhadores (valores <= 0 usam os processadores disponíveis).
+ * @param resultado Estrutura onde é devolvido o resultado.
+ * @return 1 em caso de sucesso, 0 se o ficheiro não abrir ou faltar memória.
+ */
+int carregarEmPipeline(const char* ficheiro, int numTrabalhadores, ResultadoPipeline* resultado) {
+    if (!resultado) return 0;
+    memset(resultado, 0, sizeof(ResultadoPipeline));
+
+    ContextoPipeline ctx = { 0 };
+    ctx.ficheiro = fopen(ficheiro, "r");
+    if (!ctx.ficheiro) return 0;
+
+    // O leitor ocupa uma thread; os trabalhadores ficam com as restantes
+    if (numTrabalhadores <= 0) numTrabalhadores = numeroThreads() > 1 ? numeroThreads() - 1 : 1;
+    ctx.numTrabalhadores = numTrabalhadores;
+    ctx.antenas = criarArmazem(NULL);
+    ctx.trabalhadores = reservarMemoriaZeros(MEM_OUTROS, numTrabalhadores, sizeof(Trabalhador));
+    ctx.lotes = reservarMemoriaZeros(MEM_OUTROS, numTrabalhadores, sizeof(Lote*));
+    int ok = ctx.antenas && ctx.trabalhadores && ctx.lotes;
+    for (int w = 0; ok && w < numTrabalhadores; w++) {
+        Trabalhador* t = &ctx.trabalhadores[w];
+        t->livres = -1;
+        t->pendentesX = -1;
+        t->grelha = &ctx.grelha;
+        ok = iniciarFila(&t->fila) && (ctx.lotes[w] = novoLote()) != NULL;
+    }
+
+    if (ok) {
+        executarParalelo(numTrabalhadores + 1, tarefaPipeline, &ctx);
+        ok = !ctx.erro;
+        for (int w = 0; w < numTrabalhadores; w++) ok = ok && !ctx.trabalhadores[w].erro;
+        if (ok) ok = juntarResultados(&ctx, resultado);
+    }
+    fclose(ctx.ficheiro);
+
+    if (ctx.trabalhadores) {
+        for (int w = 0; w < numTrabalhadores; w++) libertarTrabalhador(&ctx.trabalhadores[w]);
+    }
+    if (ctx.lotes) {
+        for (int w = 0; w < numTrabalhadores; w++) {
+            if (ctx.lotes[w]) libertarLote(ctx.lotes[w]);
+        }
+    }
+    libertarMemoria(MEM_OUTROS, ctx.trabalhadores, (size_t)numTrabalhadores * sizeof(Trabalhador));
+    libertarMemoria(MEM_OUTROS, ctx.lotes, (size_t)numTrabalhadores * sizeof(Lote*));
+    libertarGrelhaEfeitos(&ctx.grelha);
+    libertarArmazem(ctx.antenas);
+    return ok;
+}
+#pragma endregion
+
+#pragma region libertarResultadoPipeline
+/**
+ * @brief Liberta o grafo e os efeitos de um resultado.
+ * @param resultado Resultado de carregarEmPipeline.
+ */
+void libertarResultadoPipeline(ResultadoPipeline* resultado) {
+    if (!resultado) return;
+    libertarGrafo(resultado->grafo);
+    limparEfeitos(resultado->efeitos);
+    memset(resultado, 0, sizeof(ResultadoPipeline));
+}
+#pragma endregion
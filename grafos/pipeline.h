@@ -0,0 +1,46 @@
+/**
+ * @author Tomás Cerqueira Gomes (a31501@alunos.ipca.pt)
+ * @date 2025-05-18
+ *
+ * @file pipeline.h
+ * @brief Leitura do mapa em pipeline com o cálculo dos efeitos e do grafo.
+*/
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "grafos.h"
+
+/**
+ * @brief Resultado de uma leitura em pipeline.
+ */
+typedef struct ResultadoPipeline {
+    GR* grafo; //Grafo com as antenas lidas (LIGACAO_GRUPO, como construirGrafo)
+    Efeito* efeitos; //Efeitos harmónicos (sem repetições)
+    int largura; //Largura do mapa
+    int altura; //Altura do mapa
+} ResultadoPipeline;
+
+/**
+ * @brief Lê o mapa e calcula os efeitos harmónicos e o grafo à medida que o ficheiro é lido.
+ *
+ * A thread que chama lê o ficheiro por bandas de linhas e envia as antenas de cada banda,
+ * por filas SPSC sem locks, para os trabalhadores. Cada frequência pertence a um só
+ * trabalhador, que junta cada nova antena às antenas da mesma frequência já vistas:
+ * cria as arestas do grafo e percorre a reta de cada novo par. Como a altura final só é
+ * conhecida no fim, as retas que saem pelas linhas ainda não lidas ficam pendentes,
+ * indexadas pela linha onde continuam, e avançam quando essa linha chega.
+ * Os efeitos são os de deduzirEfeitosHarmonicos e o grafo é equivalente ao de construirGrafo.
+ * @param ficheiro Nome do ficheiro de entrada.
+ * @param numTrabalhadores Número de trabalhadores (valores <= 0 usam os processadores disponíveis).
+ * @param resultado Estrutura onde é devolvido o resultado.
+ * @return 1 em caso de sucesso, 0 se o ficheiro não abrir ou faltar memória.
+ */
+int carregarEmPipeline(const char* ficheiro, int numTrabalhadores, ResultadoPipeline* resultado);
+
+/**
+ * @brief Liberta o grafo e os efeitos de um resultado.
+ * @param resultado Resultado de carregarEmPipeline.
+ */
+void libertarResultadoPipeline(ResultadoPipeline* resultado);
+
+#endif
@@ -0,0 +1,498 @@
+/**
+ * @author Tomás Cerqueira Gomes (a31501@alunos.ipca.pt)
+ * @date 2025-05-18
+ *
+ * @file vigia.c
+ * @brief Implementação do modo de vigia (inotify + diferenças por linha).
+*/
+
+#include "vigia.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+#define ESPERA_EVENTOS_MS 50 //Intervalo máximo entre eventos juntos numa só atualização
+#define MIN_LIVRES_RECONSTRUIR 1024 //Posições livres no armazém a partir das quais se pode compactar
+
+#pragma region LinhaMapa
+/**
+ * @brief Linha do ficheiro (sem o '\n').
+ */
+typedef struct LinhaMapa {
+    const char* texto; //Início da linha no texto do ficheiro
+    size_t comprimento; //Número de bytes da linha
+} LinhaMapa;
+
+/**
+ * @brief Lê o ficheiro inteiro para memória.
+ * @param ficheiro Nome do ficheiro.
+ * @param tamanho Ponteiro onde é guardado o número de bytes lidos.
+ * @param capacidade Ponteiro onde é guardado o número de bytes reservados.
+ * @return Texto lido (a libertar com libertarMemoria em MEM_OUTROS), ou NULL em caso de erro.
+ */
+static char* lerTexto(const char* ficheiro, size_t* tamanho, size_t* capacidade) {
+    FILE* file = fopen(ficheiro, "rb");
+    if (!file) return NULL;
+
+    size_t lidos = 0, n;
+    *capacidade = 65536;
+    char* texto = reservarMemoria(MEM_OUTROS, *capacidade);
+    while (texto && (n = fread(texto + lidos, 1, *capacidade - lidos, file)) > 0) {
+        lidos += n;
+        if (lidos == *capacidade) {
+            char* maior = redimensionarMemoria(MEM_OUTROS, texto, *capacidade, *capacidade * 2);
+            if (!maior) {
+                libertarMemoria(MEM_OUTROS, texto, *capacidade);
+                texto = NULL;
+                break;
+            }
+            texto = maior;
+            *capacidade *= 2;
+        }
+    }
+    fclose(file);
+    *tamanho = lidos;
+    return texto;
+}
+
+/**
+ * @brief Separa o texto em linhas e calcula as dimensões do mapa (como obterDimensoesMapa).
+ * @param texto Texto do ficheiro.
+ * @param tamanho Número de bytes do texto.
+ * @param numLinhas Ponteiro onde é guardado o número de linhas.
+ * @param largura Ponteiro onde é guardada a largura (maior número de colunas, sem '\r').
+ * @param capacidade Ponteiro onde é guardado o número de linhas reservadas.
+ * @return Vetor de linhas (a libertar com libertarMemoria em MEM_OUTROS), ou NULL se faltar memória.
+ */
+static LinhaMapa* separarLinhas(const char* texto, size_t tamanho, int* numLinhas, int* largura,
+                                size_t* capacidade) {
+    *capacidade = 64;
+    LinhaMapa* linhas = reservarMemoria(MEM_OUTROS, *capacidade * sizeof(LinhaMapa));
+    if (!linhas) return NULL;
+
+    *numLinhas = 0;
+    *largura = 0;
+    size_t inicio = 0;
+    while (inicio < tamanho) {
+        size_t fim = inicio;
+        int colunas = 0;
+        while (fim < tamanho && texto[fim] != '\n') {
+            if (texto[fim] != '\r') colunas++;
+            fim++;
+        }
+        if (fim == tamanho && colunas == 0) break; // Última linha vazia sem '\n'
+
+        if ((size_t)*numLinhas == *capacidade) {
+            LinhaMapa* maior = redimensionarMemoria(MEM_OUTROS, linhas, *capacidade * sizeof(LinhaMapa),
+                                                    *capacidade * 2 * sizeof(LinhaMapa));
+            if (!maior) {
+                libertarMemoria(MEM_OUTROS, linhas, *capacidade * sizeof(LinhaMapa));
+                return NULL;
+            }
+            linhas = maior;
+            *capacidade *= 2;
+        }
+        linhas[*numLinhas].texto = texto + inicio;
+        linhas[*numLinhas].comprimento = fim - inicio;
+        (*numLinhas)++;
+        if (colunas > *largura) *largura = colunas;
+        inicio = fim + 1;
+    }
+    return linhas;
+}
+
+/**
+ * @brief Hash FNV-1a de uma linha (os '\r' são ignorados).
+ */
+static uint64_t hashLinha(const LinhaMapa* linha) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < linha->comprimento; i++) {
+        if (linha->texto[i] == '\r') continue;
+        h ^= (unsigned char)linha->texto[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+/**
+ * @brief Indica se um carácter do mapa é uma antena (as regras de carregarAntenasDeFicheiro).
+ */
+static int ehAntena(char c) {
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+}
+#pragma endregion
+
+#pragma region adicionarAntenaVigia
+/**
+ * @brief Retira do conjunto de efeitos as retas entre (x, y) e os primeiros n índices de um grupo.
+ */
+static void retirarPares(const GR* grafo, ConjuntoEfeitos* efeitos, const GrupoIndices* grupo, uint32_t n,
+                         uint32_t ignorar, int x, int y) {
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t outro = grupo->indices[i];
+        if (outro == ignorar) continue;
+        conjuntoRemoverPar(efeitos, x, y, armazemX(grafo->antenas, outro), armazemY(grafo->antenas, outro));
+    }
+}
+
+/**
+ * @brief Acrescenta uma antena ao grafo e as retas dos seus novos pares ao conjunto de efeitos.
+ *
+ * Os pares são as antenas do grupo da frequência (e não as arestas do vértice), pelo que o
+ * conjunto não depende do modo de ligação. As retas são acrescentadas antes da antena e
+ * retiradas se alguma das operações falhar. Com efeitos a NULL só o grafo é alterado.
+ * @return 1 em caso de sucesso, 0 em caso de erro (nada fica alterado).
+ */
+static int adicionarAntenaVigia(GR* grafo, ConjuntoEfeitos* efeitos, char frequencia, int x, int y) {
+    const GrupoIndices* grupo = &grafo->grupos[(unsigned char)frequencia];
+    uint32_t n = efeitos ? grupo->num : 0;
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t outro = grupo->indices[i];
+        if (!conjuntoAdicionarPar(efeitos, x, y, armazemX(grafo->antenas, outro), armazemY(grafo->antenas, outro))) {
+            retirarPares(grafo, efeitos, grupo, i, UINT32_MAX, x, y);
+            return 0;
+        }
+    }
+    if (!grafoAdicionarAntena(grafo, frequencia, x, y)) {
+        retirarPares(grafo, efeitos, grupo, n, UINT32_MAX, x, y);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Remove uma antena do grafo e retira as retas dos seus pares do conjunto de efeitos (se não for NULL).
+ */
+static void removerAntenaVigia(EstadoVigia* estado, ConjuntoEfeitos* efeitos, Vertice* v, int x, int y) {
+    GR* grafo = estado->grafo;
+    const GrupoIndices* grupo = &grafo->grupos[(unsigned char)armazemFrequencia(grafo->antenas, v->antena)];
+    if (efeitos) retirarPares(grafo, efeitos, grupo, grupo->num, v->antena, x, y);
+    grafoRemoverAntena(grafo, x, y);
+    estado->livres++;
+}
+#pragma endregion
+
+#pragma region aplicarLinha
+/**
+ * @brief Aplica uma linha alterada.
+ *
+ * No passo 0 remove as antenas que desapareceram ou mudaram de frequência; no passo 1
+ * acrescenta as novas. Todas as linhas fazem o passo 0 antes de qualquer passo 1.
+ * @param estado Estado do modo de vigia.
+ * @param efeitos Conjunto de efeitos a manter, ou NULL para alterar só o grafo.
+ * @param linha Nova linha.
+ * @param y Número da linha.
+ * @param passo 0 para remoções, 1 para adições.
+ * @param alteracoes Resumo a atualizar.
+ * @return 1 em caso de sucesso, 0 se faltar memória.
+ */
+static int aplicarLinha(EstadoVigia* estado, ConjuntoEfeitos* efeitos, const LinhaMapa* linha, int y, int passo,
+                        AlteracoesVigia* alteracoes) {
+    GR* grafo = estado->grafo;
+    int x = 0;
+    for (size_t i = 0; i < linha->comprimento; i++) {
+        char c = linha->texto[i];
+        if (c == '\r') continue;
+        char nova = ehAntena(c) ? c : 0;
+        Vertice* v = procurarVertice(grafo, x, y);
+        char antiga = v ? armazemFrequencia(grafo->antenas, v->antena) : 0;
+
+        if (passo == 0 && antiga && antiga != nova) {
+            removerAntenaVigia(estado, efeitos, v, x, y);
+            alteracoes->antenasRemovidas++;
+        } else if (passo == 1 && nova && !antiga) {
+            if (!adicionarAntenaVigia(grafo, efeitos, nova, x, y)) return 0;
+            alteracoes->antenasAdicionadas++;
+        }
+        x++;
+    }
+
+    // A linha pode ter ficado mais curta
+    for (; passo == 0 && x < estado->largura; x++) {
+        Vertice* v = procurarVertice(grafo, x, y);
+        if (v) {
+            removerAntenaVigia(estado, efeitos, v, x, y);
+            alteracoes->antenasRemovidas++;
+        }
+    }
+    return 1;
+}
+#pragma endregion
+
+#pragma region reconstruirVigia
+/**
+ * @brief Cria o conjunto de efeitos de um mapa com as retas de todos os pares de cada grupo de frequência.
+ * @param grafo Grafo com as antenas do mapa.
+ * @param largura Largura do mapa.
+ * @param altura Altura do mapa.
+ * @return Conjunto criado, ou NULL se faltar memória.
+ */
+static ConjuntoEfeitos* efeitosDosGrupos(const GR* grafo, int largura, int altura) {
+    ConjuntoEfeitos* efeitos = criarConjuntoEfeitos(largura, altura);
+    for (int f = 1; efeitos && f < 256; f++) {
+        const GrupoIndices* grupo = &grafo->grupos[f];
+        for (uint32_t i = 0; i < grupo->num; i++) {
+            uint32_t a = grupo->indices[i];
+            for (uint32_t j = i + 1; j < grupo->num; j++) {
+                uint32_t b = grupo->indices[j];
+                if (!conjuntoAdicionarPar(efeitos, armazemX(grafo->antenas, a), armazemY(grafo->antenas, a),
+                                          armazemX(grafo->antenas, b), armazemY(grafo->antenas, b))) {
+                    libertarConjuntoEfeitos(efeitos);
+                    return NULL;
+                }
+            }
+        }
+    }
+    return efeitos;
+}
+
+/**
+ * @brief Constrói de raiz o grafo e o conjunto de efeitos e substitui os do estado.
+ * @return 1 em caso de sucesso, 0 em caso de erro (o estado fica como estava).
+ */
+static int reconstruirVigia(EstadoVigia* estado, const LinhaMapa* linhas, int numLinhas, int largura,
+                            AlteracoesVigia* alteracoes) {
+    ArmazemAntenas* antenas = criarArmazem(NULL);
+    GR* grafo = antenas ? criarGrafoSemArestas(antenas) : NULL;
+    if (!grafo) {
+        libertarArmazem(antenas);
+        return 0;
+    }
+    ConjuntoEfeitos* efeitos = criarConjuntoEfeitos(largura, numLinhas);
+    int ok = efeitos != NULL;
+
+    int adicionadas = 0;
+    for (int y = 0; ok && y < numLinhas; y++) {
+        int x = 0;
+        for (size_t i = 0; ok && i < linhas[y].comprimento; i++) {
+            char c = linhas[y].texto[i];
+            if (c == '\r') continue;
+            if (ehAntena(c)) {
+                ok = adicionarAntenaVigia(grafo, efeitos, c, x, y);
+                adicionadas++;
+            }
+            x++;
+        }
+    }
+    if (!ok) {
+        libertarGrafo(grafo);
+        libertarConjuntoEfeitos(efeitos);
+        return 0;
+    }
+
+    alteracoes->antenasAdicionadas = adicionadas;
+    alteracoes->antenasRemovidas = estado->grafo ? estado->grafo->numVertices : 0;
+    libertarGrafo(estado->grafo);
+    libertarConjuntoEfeitos(estado->efeitos);
+    estado->grafo = grafo;
+    estado->efeitos = efeitos;
+    estado->largura = largura;
+    estado->livres = 0;
+    return 1;
+}
+#pragma endregion
+
+#pragma region atualizarVigia
+/**
+ * @brief Lê de novo o ficheiro e aplica só as linhas alteradas.
+ * @param estado Estado do modo de vigia.
+ * @param alteracoes Estrutura onde é guardado o resumo (pode ser NULL).
+ * @return 1 em caso de sucesso, 0 se o ficheiro não abrir ou faltar memória.
+ */
+int atualizarVigia(EstadoVigia* estado, AlteracoesVigia* alteracoes) {
+    if (!estado) return 0;
+    struct timespec inicio, fim;
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+
+    AlteracoesVigia resumo = { 0 };
+    size_t tamanho, capTexto, capLinhas = 0;
+    char* texto = lerTexto(estado->ficheiro, &tamanho, &capTexto);
+    if (!texto) return 0;
+    int numLinhas = 0, largura;
+    LinhaMapa* linhas = separarLinhas(texto, tamanho, &numLinhas, &largura, &capLinhas);
+    size_t numHashes = numLinhas > 0 ? (size_t)numLinhas : 1;
+    uint64_t* hashes = linhas ? reservarMemoria(MEM_OUTROS, numHashes * sizeof(uint64_t)) : NULL;
+    if (!hashes) {
+        libertarMemoria(MEM_OUTROS, linhas, capLinhas * sizeof(LinhaMapa));
+        libertarMemoria(MEM_OUTROS, texto, capTexto);
+        return 0;
+    }
+    for (int y = 0; y < numLinhas; y++) hashes[y] = hashLinha(&linhas[y]);
+
+    int ok;
+    int compactar = estado->grafo && estado->livres > MIN_LIVRES_RECONSTRUIR &&
+                    estado->livres > (uint32_t)estado->grafo->numVertices;
+    if (!estado->grafo || estado->largura < 0 || compactar) {
+        ok = reconstruirVigia(estado, linhas, numLinhas, largura, &resumo);
+        resumo.reconstruido = 1;
+        resumo.linhasAlteradas = numLinhas;
+    } else {
+        // Se as dimensões mudarem os limites das retas mudam: o grafo é alterado linha a linha
+        // e o conjunto de efeitos é calculado de novo a partir dos grupos
+        int redimensionar = numLinhas != estado->altura || largura != estado->largura;
+        ConjuntoEfeitos* efeitos = redimensionar ? NULL : estado->efeitos;
+        int maxLinhas = numLinhas > estado->altura ? numLinhas : estado->altura;
+        const LinhaMapa vazia = { "", 0 }; // Linhas que deixaram de existir
+
+        // Primeiro todas as remoções, depois as adições (uma antena pode mudar de linha)
+        ok = 1;
+        for (int passo = 0; passo < 2 && ok; passo++) {
+            for (int y = 0; y < maxLinhas && ok; y++) {
+                if (y < numLinhas && y < estado->altura && hashes[y] == estado->hashLinhas[y]) continue;
+                if (passo == 0) resumo.linhasAlteradas++;
+                ok = aplicarLinha(estado, efeitos, y < numLinhas ? &linhas[y] : &vazia, y, passo, &resumo);
+            }
+        }
+        if (ok && redimensionar) {
+            efeitos = efeitosDosGrupos(estado->grafo, largura, numLinhas);
+            ok = efeitos != NULL;
+            if (ok) {
+                libertarConjuntoEfeitos(estado->efeitos);
+                estado->efeitos = efeitos;
+                estado->largura = largura;
+                resumo.efeitosRecalculados = 1;
+            }
+        }
+        if (!ok) estado->largura = -1; // Estado incompleto: a próxima atualização reconstrói tudo
+    }
+
+    if (ok) {
+        libertarMemoria(MEM_OUTROS, estado->hashLinhas,
+                        (estado->altura > 0 ? (size_t)estado->altura : 1) * sizeof(uint64_t));
+        estado->hashLinhas = hashes;
+        estado->altura = numLinhas;
+    } else {
+        libertarMemoria(MEM_OUTROS, hashes, numHashes * sizeof(uint64_t));
+    }
+    libertarMemoria(MEM_OUTROS, linhas, capLinhas * sizeof(LinhaMapa));
+    libertarMemoria(MEM_OUTROS, texto, capTexto);
+
+    clock_gettime(CLOCK_MONOTONIC, &fim);
+    resumo.milissegundos = (fim.tv_sec - inicio.tv_sec) * 1e3 + (fim.tv_nsec - inicio.tv_nsec) / 1e6;
+    if (alteracoes) *alteracoes = resumo;
+    return ok;
+}
+#pragma endregion
+
+#pragma region criarVigia
+/**
+ * @brief Carrega o mapa e cria o estado do modo de vigia.
+ * @param ficheiro Nome do ficheiro do mapa.
+ * @return Estado criado, ou NULL se o ficheiro não abrir ou faltar memória.
+ */
+EstadoVigia* criarVigia(const char* ficheiro) {
+    if (!ficheiro) return NULL;
+    EstadoVigia* estado = reservarMemoriaZeros(MEM_OUTROS, 1, sizeof(EstadoVigia));
+    if (!estado) return NULL;
+    estado->ficheiro = reservarMemoria(MEM_OUTROS, strlen(ficheiro) + 1);
+    if (estado->ficheiro) strcpy(estado->ficheiro, ficheiro);
+    if (!estado->ficheiro || !atualizarVigia(estado, NULL)) {
+        libertarVigia(estado);
+        return NULL;
+    }
+    return estado;
+}
+#pragma endregion
+
+#pragma region vigiarFicheiro
+/**
+ * @brief Lê os eventos pendentes e indica se algum diz respeito ao ficheiro vigiado.
+ * @param fd Descritor do inotify.
+ * @param nome Nome do ficheiro (sem a pasta).
+ * @return 1 se houve um evento do ficheiro, 0 se não houve, 2 se a leitura foi interrompida
+ *         por um sinal, -1 em caso de erro.
+ */
+static int lerEventos(int fd, const char* nome) {
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t n = read(fd, buffer, sizeof(buffer));
+    if (n < 0) return errno == EINTR ? 2 : -1;
+
+    int relevante = 0;
+    for (char* p = buffer; p < buffer + n;) {
+        struct inotify_event* evento = (struct inotify_event*)p;
+        if (evento->len > 0 && strcmp(evento->name, nome) == 0) relevante = 1;
+        p += sizeof(struct inotify_event) + evento->len;
+    }
+    return relevante;
+}
+
+/**
+ * @brief Vigia o ficheiro com inotify e chama atualizarVigia sempre que ele muda.
+ * @param estado Estado do modo de vigia.
+ * @param aoAtualizar Função chamada depois de cada atualização (pode ser NULL).
+ * @param arg Argumento passado a aoAtualizar.
+ * @return 1 se aoAtualizar pediu para parar, 0 em caso de erro do inotify.
+ */
+int vigiarFicheiro(EstadoVigia* estado, AoAtualizarVigia aoAtualizar, void* arg) {
+    if (!estado) return 0;
+
+    // Pasta e nome do ficheiro
+    char pasta[4096];
+    const char* barra = strrchr(estado->ficheiro, '/');
+    const char* nome = barra ? barra + 1 : estado->ficheiro;
+    size_t tamanhoPasta = barra ? (size_t)(barra - estado->ficheiro) : 0;
+    if (tamanhoPasta >= sizeof(pasta)) return 0;
+    if (barra) {
+        memcpy(pasta, estado->ficheiro, tamanhoPasta);
+        pasta[tamanhoPasta] = '\0';
+        if (tamanhoPasta == 0) strcpy(pasta, "/");
+    } else {
+        strcpy(pasta, ".");
+    }
+
+    int fd = inotify_init1(IN_CLOEXEC);
+    if (fd < 0) return 0;
+    if (inotify_add_watch(fd, pasta, IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0) {
+        close(fd);
+        return 0;
+    }
+
+    int resultado = 0;
+    for (;;) {
+        int r = lerEventos(fd, nome);
+        if (r < 0) break;
+        if (r == 2 && aoAtualizar && !aoAtualizar(estado, NULL, arg)) {
+            resultado = 1;
+            break;
+        }
+        if (r != 1) continue;
+
+        // Juntar os eventos de uma mesma gravação
+        struct pollfd p = { fd, POLLIN, 0 };
+        while (poll(&p, 1, ESPERA_EVENTOS_MS) > 0) {
+            int seguinte = lerEventos(fd, nome);
+            if (seguinte < 0 || seguinte == 2) break;
+        }
+
+        // Se a atualização falhar (ficheiro ainda a meio de ser gravado) aoAtualizar recebe NULL
+        AlteracoesVigia alteracoes;
+        int atualizado = atualizarVigia(estado, &alteracoes);
+        if (aoAtualizar && !aoAtualizar(estado, atualizado ? &alteracoes : NULL, arg)) {
+            resultado = 1;
+            break;
+        }
+    }
+    close(fd);
+    return resultado;
+}
+#pragma endregion
+
+#pragma region libertarVigia
+/**
+ * @brief Liberta o estado do modo de vigia.
+ * @param estado Estado do modo de vigia.
+ */
+void libertarVigia(EstadoVigia* estado) {
+    if (!estado) return;
+    libertarGrafo(estado->grafo);
+    libertarConjuntoEfeitos(estado->efeitos);
+    libertarMemoria(MEM_OUTROS, estado->hashLinhas, (estado->altura > 0 ? (size_t)estado->altura : 1) * sizeof(uint64_t));
+    if (estado->ficheiro) libertarMemoria(MEM_OUTROS, estado->ficheiro, strlen(estado->ficheiro) + 1);
+    libertarMemoria(MEM_OUTROS, estado, sizeof(EstadoVigia));
+}
+#pragma endregion
@@ -0,0 +1,97 @@
+/**
+ * @author Tomás Cerqueira Gomes (a31501@alunos.ipca.pt)
+ * @date 2025-05-18
+ *
+ * @file vigia.h
+ * @brief Modo de vigia: recarrega o mapa quando o ficheiro muda, aplicando só as diferenças.
+*/
+#ifndef VIGIA_H
+#define VIGIA_H
+
+#include "grafos.h"
+
+/**
+ * @brief Estado do mapa vigiado.
+ */
+typedef struct EstadoVigia {
+    char* ficheiro; //Nome do ficheiro vigiado
+    GR* grafo; //Grafo das antenas (LIGACAO_GRUPO)
+    ConjuntoEfeitos* efeitos; //Efeitos harmónicos do mapa
+    uint64_t* hashLinhas; //Hash de cada linha do ficheiro
+    int largura; //Largura do mapa
+    int altura; //Altura do mapa (número de linhas)
+    uint32_t livres; //Posições do armazém libertadas desde a última reconstrução
+} EstadoVigia;
+
+/**
+ * @brief Resumo de uma atualização.
+ */
+typedef struct AlteracoesVigia {
+    int linhasAlteradas; //Linhas com hash diferente
+    int antenasAdicionadas; //Antenas acrescentadas
+    int antenasRemovidas; //Antenas removidas
+    int reconstruido; //1 se o mapa foi reconstruído por inteiro (primeira leitura, erro anterior ou compactação)
+    int efeitosRecalculados; //1 se as dimensões mudaram e o conjunto de efeitos foi calculado de novo
+    double milissegundos; //Duração da atualização
+} AlteracoesVigia;
+
+/**
+ * @brief Função chamada depois de cada atualização do modo de vigia.
+ *
+ * Também é chamada, com alteracoes a NULL, quando a espera por eventos é interrompida
+ * por um sinal ou a atualização falha (ficheiro ainda a meio de ser gravado), para que
+ * possa pedir para parar (por exemplo, depois de um SIGINT).
+ * @return 1 para continuar a vigiar, 0 para parar.
+ */
+typedef int (*AoAtualizarVigia)(EstadoVigia* estado, const AlteracoesVigia* alteracoes, void* arg);
+
+/**
+ * @brief Carrega o mapa e cria o estado do modo de vigia.
+ *
+ * Os efeitos mantidos são os harmónicos (os de deduzirEfeitosHarmonicos e de
+ * carregarEmPipeline), e não os da regra do ponto médio de deduzirEfeitosNefastos.
+ * A regra do ponto médio junta antenas de qualquer frequência, pelo que cada alteração
+ * obrigaria a rever todas as antenas do mapa; com os efeitos harmónicos basta rever o
+ * grupo da frequência da antena alterada, tal como no grafo.
+ * @param ficheiro Nome do ficheiro do mapa.
+ * @return Estado criado, ou NULL se o ficheiro não abrir ou faltar memória.
+ */
+EstadoVigia* criarVigia(const char* ficheiro);
+
+/**
+ * @brief Lê de novo o ficheiro e aplica só as linhas alteradas.
+ *
+ * As linhas são comparadas pelo hash. Em cada linha alterada, as antenas que desapareceram
+ * ou mudaram de frequência são removidas do grafo (retirando as retas dos seus pares do
+ * conjunto de efeitos) e as novas são acrescentadas. Se as dimensões do mapa mudarem, o
+ * grafo continua a ser alterado só nas linhas diferentes, mas como os limites das retas
+ * mudam o conjunto de efeitos é calculado de novo com os pares de cada grupo (O(m²) por
+ * grupo de m antenas). O mapa só é reconstruído por inteiro na primeira leitura, depois
+ * de uma atualização falhada ou se o armazém tiver mais posições livres do que antenas.
+ * @param estado Estado do modo de vigia.
+ * @param alteracoes Estrutura onde é guardado o resumo (pode ser NULL).
+ * @return 1 em caso de sucesso, 0 se o ficheiro não abrir ou faltar memória.
+ */
+int atualizarVigia(EstadoVigia* estado, AlteracoesVigia* alteracoes);
+
+/**
+ * @brief Vigia o ficheiro com inotify e chama atualizarVigia sempre que ele muda.
+ *
+ * É vigiada a pasta do ficheiro, para apanhar também os editores que gravam num ficheiro
+ * temporário e o mudam de nome. Eventos seguidos (até 50 ms de intervalo) são juntos numa
+ * só atualização. Para que um sinal interrompa a espera, o seu tratamento deve ser instalado
+ * sem SA_RESTART.
+ * @param estado Estado do modo de vigia.
+ * @param aoAtualizar Função chamada depois de cada atualização (pode ser NULL).
+ * @param arg Argumento passado a aoAtualizar.
+ * @return 1 se aoAtualizar pediu para parar, 0 em caso de erro do inotify.
+ */
+int vigiarFicheiro(EstadoVigia* estado, AoAtualizarVigia aoAtualizar, void* arg);
+
+/**
+ * @brief Liberta o estado do modo de vigia.
+ * @param estado Estado do modo de vigia.
+ */
+void libertarVigia(EstadoVigia* estado);
+
+#endif